@@ -0,0 +1,51 @@
+#include "AllocCounter.h"
+
+#ifdef GOMOKU_COUNT_ALLOCS
+#include <cstdlib>
+#include <new>
+
+static thread_local long long allocCount = 0;
+
+long long AllocCounter::count()
+{
+	return allocCount;
+}
+
+void* operator new(std::size_t size)
+{
+	allocCount++;
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+#else
+long long AllocCounter::count()
+{
+	return 0;
+}
+#endif
@@ -0,0 +1,7 @@
+#pragma once
+
+//counts heap allocations made by the calling thread
+//only active when built with GOMOKU_COUNT_ALLOCS, the search asserts it stays flat
+namespace AllocCounter {
+	long long count();
+}
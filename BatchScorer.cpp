@@ -0,0 +1,70 @@
+#include "BatchScorer.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BATCH_SCORER_AVX2
+#include <immintrin.h>
+#endif
+
+typedef void(*ScoreFn)(const int* table, const int (*before)[BatchScorer::MAX_CANDIDATES],
+	const int (*after)[BatchScorer::MAX_CANDIDATES], int* scores, int count);
+
+static void scoreScalar(const int* table, const int (*before)[BatchScorer::MAX_CANDIDATES],
+	const int (*after)[BatchScorer::MAX_CANDIDATES], int* scores, int count)
+{
+	for (int i = 0; i < count; i++) {
+		int s = 0;
+		for (int lane = 0; lane < BatchScorer::LANES; lane++) {
+			s += table[after[lane][i]] - table[before[lane][i]];
+		}
+		scores[i] = s;
+	}
+}
+
+#ifdef BATCH_SCORER_AVX2
+__attribute__((target("avx2")))
+static void scoreAVX2(const int* table, const int (*before)[BatchScorer::MAX_CANDIDATES],
+	const int (*after)[BatchScorer::MAX_CANDIDATES], int* scores, int count)
+{
+	//count is padded to a multiple of 8
+	for (int i = 0; i < count; i += 8) {
+		__m256i acc = _mm256_setzero_si256();
+		for (int lane = 0; lane < BatchScorer::LANES; lane++) {
+			__m256i a = _mm256_loadu_si256((const __m256i*)&after[lane][i]);
+			__m256i b = _mm256_loadu_si256((const __m256i*)&before[lane][i]);
+			acc = _mm256_add_epi32(acc, _mm256_i32gather_epi32(table, a, 4));
+			acc = _mm256_sub_epi32(acc, _mm256_i32gather_epi32(table, b, 4));
+		}
+		_mm256_storeu_si256((__m256i*)&scores[i], acc);
+	}
+}
+#endif
+
+//picked once, the same binary runs on machines without AVX2
+static ScoreFn pickScoreFn()
+{
+#ifdef BATCH_SCORER_AVX2
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return scoreAVX2;
+#endif
+	return scoreScalar;
+}
+
+static const ScoreFn scoreFn = pickScoreFn();
+
+void BatchScorer::pad()
+{
+	//code 0 looks up to 0, so padding adds nothing
+	for (int i = count; i % 8 != 0; i++) {
+		for (int lane = 0; lane < LANES; lane++) {
+			before[lane][i] = 0;
+			after[lane][i] = 0;
+		}
+	}
+}
+
+void BatchScorer::score(const int* table)
+{
+	pad();
+	scoreFn(table, before, after, scores, (count + 7) / 8 * 8);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "Board.h"
+
+//scores a whole set of candidate moves at once
+//placing a stone only changes the 4 lines through it, so a candidate's score is
+//the board score plus, for each of those lines, lookup(segment with the stone)
+//minus lookup(segment without it). both sides' codes are packed per candidate
+//as LANES columns, stored lane major so 8 candidates gather in one go
+class BatchScorer {
+public:
+	static const int LANES = 8;
+	//board cells rounded up to a multiple of 8
+	static const int MAX_CANDIDATES = (BOARDSIZE * BOARDSIZE + 7) / 8 * 8;
+
+	int before[LANES][MAX_CANDIDATES];
+	int after[LANES][MAX_CANDIDATES];
+	int scores[MAX_CANDIDATES];
+	int count = 0;
+
+	//scores[i] = sum over lanes of table[after] - table[before]
+	//uses AVX2 gathers when the cpu has them
+	void score(const int* table);
+
+private:
+	void pad();
+};
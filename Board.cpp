@@ -1,5 +1,34 @@
 #include "Board.h"
 
+namespace {
+
+//splitmix64, deterministic so the keys are the same in every build and process
+constexpr uint64_t mix(uint64_t z)
+{
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+struct ZobristKeys {
+	//[piece][cell], empty cells hash to 0
+	uint64_t keys[3][BOARDSIZE * BOARDSIZE];
+	uint64_t side;
+
+	constexpr ZobristKeys() : keys(), side(mix(0x9e3779b97f4a7c15ULL))
+	{
+		for (int p = 1; p < 3; p++) {
+			for (int cell = 0; cell < BOARDSIZE * BOARDSIZE; cell++) {
+				keys[p][cell] = mix(0x9e3779b97f4a7c15ULL * (uint64_t)(p * BOARDSIZE * BOARDSIZE + cell + 1));
+			}
+		}
+	}
+};
+
+constexpr ZobristKeys zobrist;
+
+}
+
 Board::Board() {
 
 }
@@ -9,6 +38,8 @@ void Board::placePiece(int x, int y, Piece p)
 {
 	if (p < 0 || p > 2)
 		return;
+	int cell = x * BOARDSIZE + y;
+	hash ^= zobrist.keys[board[x][y]][cell] ^ zobrist.keys[p][cell];
 	board[x][y] = p;
 }
 
@@ -17,6 +48,26 @@ Piece Board::getPiece(int x, int y)
 	return board[x][y];
 }
 
+uint64_t Board::getHash() const
+{
+	return hash;
+}
+
+uint64_t Board::sideKey()
+{
+	return zobrist.side;
+}
+
+void Board::rehash()
+{
+	hash = 0;
+	for (int i = 0; i < BOARDSIZE; i++) {
+		for (int j = 0; j < BOARDSIZE; j++) {
+			hash ^= zobrist.keys[board[i][j]][i * BOARDSIZE + j];
+		}
+	}
+}
+
 //I wish writing an interface could be this simple
 std::ostream & operator<<(std::ostream & stream, const Board & board)
 {
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <iostream>
 
 const int BOARDSIZE = 15;
@@ -21,15 +22,20 @@ public:
 				this->board[i][j] = board[i][j];
 			}
 		}
+		rehash();
 	}
 	void placePiece(int x,int y,Piece p);
 	Piece getPiece(int x, int y);
+	//64 bit zobrist hash of the stones, placePiece keeps it up to date.
+	//the keys are fixed at compile time so every process agrees on them
+	uint64_t getHash() const;
+	//xor into a hash to tell apart positions with different sides to move
+	static uint64_t sideKey();
 	friend std::ostream& operator<< (std::ostream& stream, const Board& gomoku);
 
 private:
-	//TODO implement zobristHashing and transposition
-	int zobristHash;
-	bool hashDirty = true;
+	void rehash();
+	uint64_t hash = 0;
 	//maybe store it in a way that is locality friendly
 	Piece board[BOARDSIZE][BOARDSIZE] = { {Piece::EMPTY} };
 };
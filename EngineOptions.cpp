@@ -0,0 +1,111 @@
+#include "EngineOptions.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+static bool parseInt(const std::string& value, int& out)
+{
+	if (value == "true") {
+		out = 1;
+		return true;
+	}
+	if (value == "false") {
+		out = 0;
+		return true;
+	}
+	char* end = nullptr;
+	long v = std::strtol(value.c_str(), &end, 10);
+	if (value.empty() || *end != '\0')
+		return false;
+	out = (int)v;
+	return true;
+}
+
+static std::string trim(std::string s)
+{
+	s.erase(0, s.find_first_not_of(" \t\r"));
+	s.erase(s.find_last_not_of(" \t\r") + 1);
+	return s;
+}
+
+bool EngineOptions::set(const std::string& key, const std::string& value)
+{
+	int v;
+	if (!parseInt(value, v))
+		return false;
+	if (key == "depth") depth = std::max(1, v);
+	else if (key == "time") timeMs = std::max(0, v);
+	else if (key == "width") width = std::max(0, v);
+	else if (key == "margin") margin = std::max(1, v);
+	else if (key == "threads") threads = std::max(0, v);
+	else if (key == "pvs") features.nullWindow = v != 0;
+	else if (key == "lmr") features.lmr = v != 0;
+	else if (key == "futility") features.futility = v != 0;
+	else if (key == "qsearch") features.quiescence = v != 0;
+	else if (key == "qthrees") features.quiescenceThrees = v != 0;
+	else return false;
+	return true;
+}
+
+bool EngineOptions::load(const std::string& file)
+{
+	std::ifstream in(file);
+	if (!in) {
+		std::cerr << "cannot open " << file << std::endl;
+		return false;
+	}
+	bool ok = true;
+	std::string line;
+	for (int n = 1; std::getline(in, line); n++) {
+		line = line.substr(0, line.find('#'));
+		auto eq = line.find('=');
+		if (trim(line).empty())
+			continue;
+		if (eq == std::string::npos || !set(trim(line.substr(0, eq)), trim(line.substr(eq + 1)))) {
+			std::cerr << file << ":" << n << ": bad option " << line << std::endl;
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+std::string EngineOptions::toString() const
+{
+	std::ostringstream out;
+	out << "depth=" << depth << " time=" << timeMs << " width=" << width << " margin=" << margin
+		<< " threads=" << threads << " pvs=" << features.nullWindow << " lmr=" << features.lmr
+		<< " futility=" << features.futility << " qsearch=" << features.quiescence
+		<< " qthrees=" << features.quiescenceThrees;
+	return out.str();
+}
+
+int EngineOptions::threadCount() const
+{
+	if (threads > 0)
+		return threads;
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+//for limits where 0 means none
+static int tighter(int value, int limit)
+{
+	if (limit == 0)
+		return value;
+	return value == 0 ? limit : std::min(value, limit);
+}
+
+void EngineOptions::limitTo(const EngineOptions& ceiling)
+{
+	depth = std::min(depth, ceiling.depth);
+	margin = std::min(margin, ceiling.margin);
+	timeMs = tighter(timeMs, ceiling.timeMs);
+	width = tighter(width, ceiling.width);
+	features.nullWindow = features.nullWindow || ceiling.features.nullWindow;
+	features.lmr = features.lmr || ceiling.features.lmr;
+	features.futility = features.futility || ceiling.features.futility;
+	features.quiescence = features.quiescence && ceiling.features.quiescence;
+	features.quiescenceThrees = features.quiescenceThrees && ceiling.features.quiescenceThrees;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <string>
+
+//optional pruning, all off by default so results match a plain alpha-beta
+struct SearchFeatures {
+	//principal variation search, every move after the first gets a null window first
+	bool nullWindow = false;
+	//late move reductions, quiet moves past the first few are searched a ply shallower with a
+	//null window and only re-searched if they beat alpha. every other move keeps its full
+	//window unless nullWindow is on too
+	bool lmr = false;
+	//at frontier nodes far below alpha, skip quiet moves
+	bool futility = false;
+	//at the horizon keep playing fives, blocks of fives and fours
+	bool quiescence = false;
+	//open threes count as forcing too in quiescence
+	bool quiescenceThrees = false;
+};
+
+//everything a search can be tuned with, the defaults are what the engine always did
+//a config file has one "key = value" per line, # starts a comment. the keys are
+// depth time width margin threads pvs lmr futility qsearch qthrees
+//and the same names work as tool flags (--depth 6) and in the server's "options" object
+struct EngineOptions {
+	//plies searched, with a time budget the deepest iterative deepening may reach
+	int depth = 4;
+	//ms per move, 0 for none
+	int timeMs = 0;
+	//candidate moves searched at each node, best first, 0 for all of them
+	int width = 0;
+	//empty rows and columns around the stones where candidates are looked for
+	int margin = 2;
+	//searches run side by side, the tools' pools and the server's pondering sessions.
+	//0 for one per core
+	int threads = 0;
+	SearchFeatures features;
+
+	//false for an unknown key or a value that isn't a number
+	bool set(const std::string& key, const std::string& value);
+	//false if the file can't be read or has bad lines, the good lines still apply
+	bool load(const std::string& file);
+	//space separated key=value pairs, set() reads each back
+	std::string toString() const;
+	//threads with 0 resolved
+	int threadCount() const;
+	//makes the search no more expensive than ceiling's: depth and margin no higher,
+	//time and width no looser, pruning ceiling has on stays on, quiescence it has off stays off
+	void limitTo(const EngineOptions& ceiling);
+};
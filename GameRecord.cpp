@@ -0,0 +1,167 @@
+#include "GameRecord.h"
+#include "Board.h"
+#include <algorithm>
+
+static const char MAGIC[4] = { 'G', 'M', 'K', 'R' };
+static const char VERSION = 1;
+//a full game is a few KB even with long engine names, anything bigger is corruption
+static const unsigned long long MAX_PAYLOAD = 64 * 1024;
+
+static void putVarint(std::string& buf, unsigned long long v)
+{
+	while (v >= 0x80) {
+		buf.push_back((char)(v | 0x80));
+		v >>= 7;
+	}
+	buf.push_back((char)v);
+}
+
+static void putSigned(std::string& buf, long long v)
+{
+	putVarint(buf, ((unsigned long long)v << 1) ^ (unsigned long long)(v >> 63));
+}
+
+static void putString(std::string& buf, const std::string& s)
+{
+	putVarint(buf, s.size());
+	buf += s;
+}
+
+//reads from a payload buffer, pos is advanced and set past the end on overrun
+static unsigned long long getVarint(const std::string& buf, size_t& pos)
+{
+	unsigned long long v = 0;
+	for (int shift = 0; pos < buf.size() && shift < 64; shift += 7) {
+		unsigned char c = (unsigned char)buf[pos++];
+		v |= (unsigned long long)(c & 0x7f) << shift;
+		if (!(c & 0x80))
+			return v;
+	}
+	pos = buf.size() + 1;
+	return 0;
+}
+
+static long long getSigned(const std::string& buf, size_t& pos)
+{
+	unsigned long long v = getVarint(buf, pos);
+	return (long long)(v >> 1) ^ -(long long)(v & 1);
+}
+
+static std::string getString(const std::string& buf, size_t& pos)
+{
+	size_t len = (size_t)getVarint(buf, pos);
+	if (pos > buf.size() || buf.size() - pos < len) {
+		pos = buf.size() + 1;
+		return "";
+	}
+	std::string s = buf.substr(pos, len);
+	pos += len;
+	return s;
+}
+
+GameRecordWriter::GameRecordWriter(const std::string& path)
+{
+	out.open(path, std::ios::binary | std::ios::app);
+	if (out && out.tellp() == 0) {
+		out.write(MAGIC, sizeof(MAGIC));
+		out.put(VERSION);
+	}
+}
+
+bool GameRecordWriter::good() const
+{
+	return (bool)out;
+}
+
+void GameRecordWriter::write(const GameRecord& record)
+{
+	buffer.clear();
+	putVarint(buffer, record.id);
+	buffer.push_back((char)record.winner);
+	putVarint(buffer, record.openingMoves);
+	putString(buffer, record.black);
+	putString(buffer, record.white);
+	putVarint(buffer, record.moves.size());
+	for (const auto& m : record.moves) {
+		buffer.push_back((char)(m.x * BOARDSIZE + m.y));
+		putSigned(buffer, m.score);
+		putVarint(buffer, m.micros);
+		putVarint(buffer, m.nodes);
+	}
+
+	std::string length;
+	putVarint(length, buffer.size());
+	out.write(length.data(), length.size());
+	out.write(buffer.data(), buffer.size());
+}
+
+void GameRecordWriter::flush()
+{
+	out.flush();
+}
+
+GameRecordReader::GameRecordReader(const std::string& path)
+{
+	in.open(path, std::ios::binary);
+	char header[sizeof(MAGIC) + 1];
+	if (in.read(header, sizeof(header))) {
+		valid = std::equal(MAGIC, MAGIC + sizeof(MAGIC), header) && header[sizeof(MAGIC)] == VERSION;
+	}
+}
+
+bool GameRecordReader::good() const
+{
+	return valid;
+}
+
+bool GameRecordReader::next(GameRecord& record)
+{
+	if (!valid)
+		return false;
+
+	unsigned long long length = 0;
+	int shift = 0;
+	int c;
+	do {
+		c = in.get();
+		if (c == EOF || shift >= 64)
+			return false;
+		length |= (unsigned long long)(c & 0x7f) << shift;
+		shift += 7;
+	} while (c & 0x80);
+	if (length > MAX_PAYLOAD) {
+		valid = false;
+		return false;
+	}
+
+	buffer.resize((size_t)length);
+	if (!in.read(&buffer[0], length))
+		return false;
+
+	size_t pos = 0;
+	record.id = getVarint(buffer, pos);
+	record.winner = pos < buffer.size() ? (unsigned char)buffer[pos++] : 0;
+	record.openingMoves = (int)getVarint(buffer, pos);
+	record.black = getString(buffer, pos);
+	record.white = getString(buffer, pos);
+	size_t count = (size_t)getVarint(buffer, pos);
+	record.moves.clear();
+	for (size_t i = 0; i < count && pos < buffer.size(); i++) {
+		RecordedMove m;
+		int cell = (unsigned char)buffer[pos++];
+		if (cell >= BOARDSIZE * BOARDSIZE)
+			break;
+		m.x = cell / BOARDSIZE;
+		m.y = cell % BOARDSIZE;
+		m.score = (int)getSigned(buffer, pos);
+		m.micros = (long long)getVarint(buffer, pos);
+		m.nodes = (long long)getVarint(buffer, pos);
+		record.moves.push_back(m);
+	}
+	//a corrupt payload stops the stream rather than handing out garbage
+	if (pos > buffer.size() || record.moves.size() != count) {
+		valid = false;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+
+//compact append-only binary game records
+//
+//file: "GMKR" + version byte, then records back to back
+//record: varint payload length, payload
+//payload: varint id, byte winner (0 none, 1 black, 2 white), varint opening moves,
+//         string black name, string white name, varint move count,
+//         per move: byte cell (x * BOARDSIZE + y), zigzag varint score,
+//                   varint search micros, varint search nodes
+//strings are a varint length followed by the bytes
+//a truncated tail (crashed writer) ends the stream cleanly, so does a corrupt record
+//(a payload over 64KB or a cell off the board)
+
+struct RecordedMove {
+	int x = 0;
+	int y = 0;
+	int score = 0;
+	long long micros = 0;
+	long long nodes = 0;
+};
+
+struct GameRecord {
+	unsigned long long id = 0;
+	int winner = 0;
+	int openingMoves = 0;
+	std::string black;
+	std::string white;
+	std::vector<RecordedMove> moves;
+};
+
+class GameRecordWriter {
+public:
+	//appends to path, writing the header if the file is new
+	explicit GameRecordWriter(const std::string& path);
+	bool good() const;
+	void write(const GameRecord& record);
+	void flush();
+
+private:
+	std::ofstream out;
+	std::string buffer;
+};
+
+class GameRecordReader {
+public:
+	explicit GameRecordReader(const std::string& path);
+	bool good() const;
+	//reads the next record into record, false at the end of the stream
+	bool next(GameRecord& record);
+
+private:
+	std::ifstream in;
+	bool valid = false;
+	std::string buffer;
+};
@@ -1,14 +1,20 @@
 #include "Gomoku.h"
-#include "BitRowBuilder.h"
+#include "AllocCounter.h"
 #include <algorithm>
+#include <cassert>
+#include <limits>
 
 Gomoku::Gomoku()
 {
+	threats.rebuild(board, patternLookup2);
+	setOptions(options);
 }
 
 Gomoku::Gomoku(const std::vector<int>& patternLookup1, const std::vector<int>& patternLookup2): 
 	patternLookup1(patternLookup1), patternLookup2(patternLookup2)
 {
+	threats.rebuild(board, this->patternLookup2);
+	setOptions(options);
 	// maxScore = (*std::max_element(patternLookup1.begin(),patternLookup1.end()));
 	// maxScore = std::max(maxScore, (*std::max_element(patternLookup2.begin(),patternLookup2.end())));
 	// wonScore = 5*maxScore;
@@ -19,27 +25,182 @@ bool Gomoku::placePiece(int x, int y)
 {
 	if (board.getPiece(x, y) != Piece::EMPTY)
 		return false;
-	board.placePiece(x, y, turn);
+	setPiece(x, y, turn);
 	turn = otherPlayer(turn);
 	return true;
 }
 
+bool Gomoku::removePiece(int x, int y)
+{
+	if (board.getPiece(x, y) == Piece::EMPTY)
+		return false;
+	setPiece(x, y, Piece::EMPTY);
+	turn = otherPlayer(turn);
+	return true;
+}
+
+Piece Gomoku::getPiece(int x, int y)
+{
+	return board.getPiece(x, y);
+}
+
+void Gomoku::setTurn(Piece p)
+{
+	turn = p;
+}
+
+void Gomoku::setPiece(int x, int y, Piece p)
+{
+	board.placePiece(x, y, p);
+	threats.update(board, x, y, patternLookup2);
+}
+
 std::pair<int,int> Gomoku::placePiece()
 {
-	//auto p = alphaBeta(4, -99999999, 99999999, true, turn);
-	auto p = negaMax(4,-99999999,99999999,turn,turn);
+#ifdef GOMOKU_COUNT_ALLOCS
+	long long allocsBefore = AllocCounter::count();
+#endif
+	nodeCount = 0;
+	lateReductions = 0;
+	futilityPrunes = 0;
+	tableCutoffs = 0;
+	if (table)
+		table->newSearch();
+	//a time budget without a SearchControl gets a control of its own for this search
+	const SearchControl* caller = control;
+	SearchControl budget;
+	if (!control && options.timeMs > 0) {
+		budget.setTimeout(options.timeMs);
+		control = &budget;
+	}
+	ScoreXY p = std::make_tuple(0, -1, -1);
+	if (control && control->hasDeadline()) {
+		//deepen one ply at a time so running out of time still leaves a move
+		for (int depth = 1; depth <= options.depth; depth++) {
+			auto cur = negaMax(depth, 0, -SCORE_BOUND, SCORE_BOUND, turn, turn);
+			if (stopped())
+				break;
+			p = cur;
+		}
+	}
+	else {
+		p = negaMax(options.depth, 0, -SCORE_BOUND, SCORE_BOUND, turn, turn);
+	}
+	control = caller;
+	if (control && control->cancelled())
+		return { -1,-1 };
 	int x = std::get<1>(p);
 	int y = std::get<2>(p);
+	lastScore = std::get<0>(p);
 	//lost already
 	if (x == -1 && y == -1) {
-		auto anyP = genBestMoves(turn)[0];
+		genBestMoves(turn, moveStack[0]);
+		auto anyP = moveStack[0].selectBest(0);
 		x = std::get<1>(anyP);
 		y = std::get<2>(anyP);
 	}
+#ifdef GOMOKU_COUNT_ALLOCS
+	//the search works out of moveStack only
+	assert(AllocCounter::count() == allocsBefore);
+#endif
 	placePiece(x, y);
 	return { x,y };
 }
 
+int Gomoku::searchScore(int depth, int ply, int alpha, int beta)
+{
+	nodeCount = 0;
+	lateReductions = 0;
+	futilityPrunes = 0;
+	tableCutoffs = 0;
+	depth = std::max(0, std::min(depth, MAX_PLY - ply));
+	return std::get<0>(negaMax(depth, ply, alpha, beta, turn, turn));
+}
+
+Piece Gomoku::getTurn() const
+{
+	return turn;
+}
+
+std::vector<std::pair<int, int>> Gomoku::bestMoves(int n)
+{
+	genBestMoves(turn, moveStack[0]);
+	std::vector<std::pair<int, int>> moves;
+	for (int i = 0; i < std::min(n, moveStack[0].count); i++) {
+		const auto& scoreXY = moveStack[0].selectBest(i);
+		moves.emplace_back(std::get<1>(scoreXY), std::get<2>(scoreXY));
+	}
+	return moves;
+}
+
+void Gomoku::setSearchControl(const SearchControl* searchControl)
+{
+	control = searchControl;
+}
+
+bool Gomoku::stopped() const
+{
+	return control && control->shouldStop(nodeCount);
+}
+
+void Gomoku::setOptions(const EngineOptions& engineOptions)
+{
+	options = engineOptions;
+	options.depth = std::max(1, std::min(options.depth, MAX_PLY));
+	options.margin = std::max(1, std::min(options.margin, BOARDSIZE));
+	const auto& f = options.features;
+	uint64_t signature = (uint64_t)options.width << 16 | (uint64_t)options.margin << 8
+		| f.nullWindow | f.lmr << 1 | f.futility << 2 | f.quiescence << 3 | f.quiescenceThrees << 4;
+	//spread the few bits over the whole key
+	optionsKey = signature * 0x9e3779b97f4a7c15ULL;
+}
+
+void Gomoku::setTranspositionTable(TranspositionTable* transpositionTable)
+{
+	table = transpositionTable;
+}
+
+uint64_t Gomoku::tableKey(Piece next) const
+{
+	return board.getHash() ^ (next == Piece::WHITE ? Board::sideKey() : 0) ^ optionsKey;
+}
+
+const EngineOptions& Gomoku::getOptions() const
+{
+	return options;
+}
+
+void Gomoku::reset()
+{
+	board = Board();
+	threats.rebuild(board, patternLookup2);
+	turn = Piece::BLACK;
+}
+
+long long Gomoku::getNodeCount() const
+{
+	return nodeCount;
+}
+
+long long Gomoku::getLateReductions() const
+{
+	return lateReductions;
+}
+
+long long Gomoku::getFutilityPrunes() const
+{
+	return futilityPrunes;
+}
+
+long long Gomoku::getTableCutoffs() const
+{
+	return tableCutoffs;
+}
+
+int Gomoku::getLastScore() const
+{
+	return lastScore;
+}
 
 int Gomoku::evalBoard(Piece player, bool isOddStep) {
 	int val = 0;
@@ -74,7 +235,8 @@ int Gomoku::evalBoard(Piece player, bool isOddStep) {
 int Gomoku::rowEval(int x, int y, int dx, int dy, Piece self, bool isOddStep)
 {
 	Piece opponent = otherPlayer(self);
-	BitRowBuilder rowBuilder;
+	//same encoding as BitRowBuilder, kept as a plain int on this hot path
+	int row = 1;
 	int val = 0;
 	for (int i = 0; i < BOARDSIZE; i++) {
 		if (x < 0 || x >= BOARDSIZE || y < 0 || y >= BOARDSIZE)
@@ -83,13 +245,13 @@ int Gomoku::rowEval(int x, int y, int dx, int dy, Piece self, bool isOddStep)
 		x += dx;
 		y += dy;
 		if (p == opponent) {
-			val += subRowEval(rowBuilder.getRow(), isOddStep);
-			rowBuilder.reset();
+			val += subRowEval(row, isOddStep);
+			row = 1;
 			continue;
 		}
-		rowBuilder.add(p == Piece::EMPTY);
+		row = (row << 1) ^ (p == Piece::EMPTY ? 0 : 1);
 	}
-	val += subRowEval(rowBuilder.getRow(), isOddStep);
+	val += subRowEval(row, isOddStep);
 	return val;
 }
 
@@ -107,23 +269,26 @@ int Gomoku::subRowEval(int subRow, bool isOddStep)
 	}
 }
 
+//relative to next, the side to move gets the even step table
+//same as scoring for start when the depth is even
+int Gomoku::staticEval(Piece next)
+{
+	return evalBoard(next, false) - evalBoard(otherPlayer(next), true);
+}
+
 Piece Gomoku::otherPlayer(Piece p)
 {
 	return p == Piece::WHITE ? Piece::BLACK : Piece::WHITE;
 }
 
 
-//this method still needs some tunning
-//let me try to optimize first
-//then I could probably allow a larger set of moves
-std::vector<Gomoku::ScoreXY> Gomoku::genBestMoves(Piece cur)
+//bounding box of the stones plus the margin, where moves are looked for
+void Gomoku::candidateBox(int& minX, int& maxX, int& minY, int& maxY)
 {
-	auto opponent = otherPlayer(cur);
-	std::vector<ScoreXY> scores;
-	int minX = BOARDSIZE / 2;
-	int maxX = BOARDSIZE / 2 + 1;
-	int minY = BOARDSIZE / 2;
-	int maxY = BOARDSIZE / 2 + 1;
+	minX = BOARDSIZE / 2;
+	maxX = BOARDSIZE / 2 + 1;
+	minY = BOARDSIZE / 2;
+	maxY = BOARDSIZE / 2 + 1;
 	for (int x = 0; x < BOARDSIZE; x++) {
 		for (int y = 0; y < BOARDSIZE; y++) {
 			auto p = board.getPiece(x, y);
@@ -135,52 +300,185 @@ std::vector<Gomoku::ScoreXY> Gomoku::genBestMoves(Piece cur)
 			}
 		}
 	}
-	minX -= 2;
-	maxX += 2;
-	minY -= 2;
-	maxY += 2;
+	minX -= options.margin;
+	maxX += options.margin;
+	minY -= options.margin;
+	maxY += options.margin;
 	minX = std::max(0, minX);
 	maxX = std::min(BOARDSIZE - 1, maxX);
 	minY = std::max(0, minY);
 	maxY = std::min(BOARDSIZE - 1, maxY);
+}
+
+//forcing moves for cur, most urgent kind only:
+//a five if cur has one, else the cells blocking the opponent's fives,
+//else cur's fours (and threes when asked). returns the kind found
+Threat Gomoku::genThreatMoves(Piece cur, MoveList& moves, bool withThrees)
+{
+	auto opponent = otherPlayer(cur);
+	int cells[ThreatIndex::CELLS];
+	moves.count = 0;
+
+	int n = threats.cells(cur, Threat::FIVE, cells);
+	if (n > 0) {
+		moves.moves[0] = std::make_tuple(threats.gain(cur, cells[0]), cells[0] / BOARDSIZE, cells[0] % BOARDSIZE);
+		moves.quiet[0] = false;
+		moves.count = 1;
+		return Threat::FIVE;
+	}
+
+	//blocking beats any attack short of a five
+	Threat kind = Threat::FIVE_BLOCK;
+	n = threats.cells(opponent, Threat::FIVE, cells);
+	Piece owner = opponent;
+	if (n == 0) {
+		kind = Threat::FOUR;
+		owner = cur;
+		n = threats.cells(cur, Threat::FOUR, cells);
+		if (withThrees) {
+			n += threats.cells(cur, Threat::THREE, cells + n);
+			//board order, so equal gains are tried in the same order as before
+			std::sort(cells, cells + n);
+		}
+	}
+	for (int i = 0; i < n; i++) {
+		moves.moves[i] = std::make_tuple(threats.gain(owner, cells[i]), cells[i] / BOARDSIZE, cells[i] % BOARDSIZE);
+		moves.quiet[i] = false;
+	}
+	moves.count = n;
+	return n > 0 ? kind : Threat::NONE;
+}
+
+//only forcing moves past the horizon, so a four on the board can't hide behind it
+Gomoku::ScoreXY Gomoku::quiesce(int qdepth, int ply, int alpha, int beta, Piece start, Piece next)
+{
+	nodeCount++;
+	if (stopped())
+		return std::make_tuple(0, -1, -1);
+
+	MoveList& moves = moveStack[ply];
+	Threat kind = genThreatMoves(next, moves, options.features.quiescenceThrees);
+	if (kind == Threat::FIVE) {
+		int x = std::get<1>(moves.moves[0]);
+		int y = std::get<2>(moves.moves[0]);
+		setPiece(x, y, next);
+		int score = evalBoard(next, true) - evalBoard(otherPlayer(next), true);
+		setPiece(x, y, Piece::EMPTY);
+		return std::make_tuple(score, x, y);
+	}
+
+	int standPat = staticEval(next);
+	if (qdepth == 0 || kind == Threat::NONE)
+		return std::make_tuple(standPat, -1, -1);
+	int bestVal = standPat;
+	//with a five to block, standing pat isn't an option
+	if (kind == Threat::FIVE_BLOCK) {
+		bestVal = -SCORE_BOUND;
+	}
+	else {
+		if (standPat >= beta)
+			return std::make_tuple(standPat, -1, -1);
+		alpha = std::max(alpha, standPat);
+	}
+
+	int bestX = -1;
+	int bestY = -1;
+	for (int i = 0; i < moves.count; i++) {
+		const auto& scoreXY = moves.selectBest(i);
+		int x = std::get<1>(scoreXY);
+		int y = std::get<2>(scoreXY);
+		setPiece(x, y, next);
+		int v = -1 * std::get<0>(quiesce(qdepth - 1, ply + 1, -1*beta, -1*alpha, start, otherPlayer(next)));
+		setPiece(x, y, Piece::EMPTY);
+		if (v > bestVal) {
+			bestX = x;
+			bestY = y;
+			bestVal = v;
+		}
+		alpha = std::max(alpha, v);
+		if (beta <= alpha)
+			break;
+	}
+	return std::make_tuple(bestVal, bestX, bestY);
+}
 
+//this method still needs some tunning
+//let me try to optimize first
+//then I could probably allow a larger set of moves
+void Gomoku::genBestMoves(Piece cur, MoveList& moves)
+{
+	auto opponent = otherPlayer(cur);
+	moves.count = 0;
+	int minX, maxX, minY, maxY;
+	candidateBox(minX, maxX, minY, maxY);
+
+	// if cur can win, then just go for it
+	if (threats.count(cur, Threat::FIVE) > 0) {
+		//an open four has two winning cells, any will do
+		int cells[ThreatIndex::CELLS];
+		threats.cells(cur, Threat::FIVE, cells);
+		int cell = cells[0];
+		moves.moves[0] = std::make_tuple(1, cell / BOARDSIZE, cell % BOARDSIZE);
+		moves.quiet[0] = false;
+		moves.count = 1;
+		return;
+	}
+
+	//every candidate shares the board score, only the 4 lines through it differ
+	int baseScore = evalBoard(cur, true) + evalBoard(opponent, true);
+	batch.count = 0;
 	for (int x = minX; x <= maxX; x++) {
 		for (int y = minY; y <= maxY; y++) {
 			auto p = board.getPiece(x, y);
 			if (p == Piece::EMPTY) {
-				board.placePiece(x, y, cur);
-				// if cur can win, then just go for it
-				if (singlePieceWinner(x, y)) {
-					// std::cout<<board<<std::endl;
-					// std::cout<<x<<" "<<y<<std::endl;
-					// board.placePiece(x, y, Piece::EMPTY);
-					return {std::make_tuple(1,x,y)};
+				int cell = x * BOARDSIZE + y;
+				int c = batch.count++;
+				for (int d = 0; d < ThreatIndex::DIRS; d++) {
+					batch.before[d][c] = threats.before(cur, d, cell);
+					batch.after[d][c] = threats.after(cur, d, cell);
+					batch.before[d + 4][c] = threats.before(opponent, d, cell);
+					batch.after[d + 4][c] = threats.after(opponent, d, cell);
 				}
-				int curScore = evalBoard(cur, true);
-				board.placePiece(x, y, opponent);
-				curScore += evalBoard(opponent, true);
-				board.placePiece(x, y, Piece::EMPTY);
-				scores.emplace_back(curScore, x, y);
+				//making or stopping a three or more is never quiet
+				moves.quiet[moves.count] = threats.level(cur, cell) == Threat::NONE
+					&& threats.level(opponent, cell) == Threat::NONE;
+				moves.moves[moves.count++] = std::make_tuple(0, x, y);
 			}
 			
 		}
 	}
-	//sorting still helps
-	std::sort(scores.begin(), scores.end(), [](const ScoreXY& lhs, const ScoreXY& rhs) {
-		return std::get<0>(lhs) > std::get<0>(rhs);
-	});
-
-	//keep top 20 scores	
-	//scores.resize(20);
+	batch.score(patternLookup1.data());
+	for (int i = 0; i < moves.count; i++) {
+		std::get<0>(moves.moves[i]) = baseScore + batch.scores[i];
+	}
+	//no full sort here, negaMax selects lazily and usually cuts off early.
+	//with a width only the best few are kept, selecting them is the start of that anyway
+	if (options.width > 0 && moves.count > options.width) {
+		for (int i = 0; i < options.width; i++)
+			moves.selectBest(i);
+		moves.count = options.width;
+	}
+}
 
-	return scores;
+const Gomoku::ScoreXY& Gomoku::MoveList::selectBest(int idx)
+{
+	int best = idx;
+	for (int i = idx + 1; i < count; i++) {
+		if (std::get<0>(moves[i]) > std::get<0>(moves[best]))
+			best = i;
+	}
+	std::swap(moves[idx], moves[best]);
+	std::swap(quiet[idx], quiet[best]);
+	return moves[idx];
 }
 
 //based on 4 steps
 // odd total step pass true, false
 // even total step pass false, true
-Gomoku::ScoreXY Gomoku::negaMax(int depth, int alpha, int beta, Piece start, Piece next) {
-	auto opponent = otherPlayer(start);
+Gomoku::ScoreXY Gomoku::negaMax(int depth, int ply, int alpha, int beta, Piece start, Piece next) {
+	nodeCount++;
+	if (stopped())
+		return std::make_tuple(0, -1, -1);
 
 	//early termination is weird...
 	// 4 B
@@ -196,19 +494,84 @@ Gomoku::ScoreXY Gomoku::negaMax(int depth, int alpha, int beta, Piece start, Pie
 		return std::make_tuple(score,-1,-1 );
 	}
 	if (depth == 0) {
-		return std::make_tuple( evalBoard(start,false) - evalBoard(opponent,true),-1,-1 );
+		if (options.features.quiescence)
+			return quiesce(QUIESCENCE_PLIES, ply, alpha, beta, start, next);
+		return std::make_tuple(staticEval(next), -1, -1);
+	}
+
+	//another search, maybe another game's, may have been here already
+	int alphaIn = alpha;
+	int tableCell = -1;
+	uint64_t key = 0;
+	if (table) {
+		key = tableKey(next);
+		TranspositionTable::Entry entry;
+		if (table->probe(key, entry)) {
+			tableCell = entry.cell;
+			//the root has to come up with its own move
+			if (ply > 0 && entry.depth >= depth && (entry.bound == TranspositionTable::Bound::EXACT
+				|| (entry.bound == TranspositionTable::Bound::LOWER && entry.score >= beta)
+				|| (entry.bound == TranspositionTable::Bound::UPPER && entry.score <= alpha))) {
+				tableCutoffs++;
+				return std::make_tuple(entry.score, entry.cell < 0 ? -1 : entry.cell / BOARDSIZE,
+					entry.cell < 0 ? -1 : entry.cell % BOARDSIZE);
+			}
+		}
 	}
 
 	int bestX = -1;
 	int bestY = -1;
-	int bestVal = -99999999;
+	int bestVal = -SCORE_BOUND;
+
+	//frontier node that is already far below alpha, quiet moves can't bring it back
+	bool futile = false;
+	int futilityBound = 0;
+	if (options.features.futility && depth == 1 && ply > 0) {
+		futilityBound = staticEval(next) + FUTILITY_MARGIN;
+		futile = futilityBound <= alpha;
+	}
 
-	for (const auto& scoreXY : genBestMoves(next)) {
+	MoveList& moves = moveStack[ply];
+	genBestMoves(next, moves);
+	//the table's best move goes first
+	for (int i = 0; tableCell >= 0 && i < moves.count; i++) {
+		if (std::get<1>(moves.moves[i]) * BOARDSIZE + std::get<2>(moves.moves[i]) == tableCell) {
+			std::get<0>(moves.moves[i]) = std::numeric_limits<int>::max();
+			break;
+		}
+	}
+	for (int i = 0; i < moves.count; i++) {
+		const auto& scoreXY = moves.selectBest(i);
 		int x = std::get<1>(scoreXY);
 		int y = std::get<2>(scoreXY);
-		board.placePiece(x,y,next);
-		auto nextScoreXY = negaMax(depth - 1, -1*beta, -1*alpha, start, otherPlayer(next));
-		int v = -1 * std::get<0>(nextScoreXY);
+		bool quiet = moves.quiet[i];
+		if (futile && i > 0 && quiet) {
+			futilityPrunes++;
+			//fail soft with the best this move could have done
+			bestVal = std::max(bestVal, futilityBound);
+			continue;
+		}
+		setPiece(x, y, next);
+		//late quiet moves get a shallower look first
+		int reduction = 0;
+		if (options.features.lmr && quiet && i >= LMR_FULL_MOVES && depth - 1 >= LMR_REDUCTION + 1) {
+			reduction = LMR_REDUCTION;
+			lateReductions++;
+		}
+		int v;
+		if (i == 0 || !(options.features.nullWindow || reduction)) {
+			v = -1 * std::get<0>(negaMax(depth - 1, ply + 1, -1*beta, -1*alpha, start, otherPlayer(next)));
+		}
+		else {
+			//null window, only proves the move is no better than alpha
+			v = -1 * std::get<0>(negaMax(depth - 1 - reduction, ply + 1, -1*alpha - 1, -1*alpha, start, otherPlayer(next)));
+			if (v > alpha && reduction) {
+				v = -1 * std::get<0>(negaMax(depth - 1, ply + 1, -1*alpha - 1, -1*alpha, start, otherPlayer(next)));
+			}
+			if (v > alpha && v < beta) {
+				v = -1 * std::get<0>(negaMax(depth - 1, ply + 1, -1*beta, -1*alpha, start, otherPlayer(next)));
+			}
+		}
 		// if (depth == 4) {
 		// 	std::cerr<<board;
 		// 	std::cerr<<v<<std::endl;
@@ -220,57 +583,32 @@ Gomoku::ScoreXY Gomoku::negaMax(int depth, int alpha, int beta, Piece start, Pie
 			bestY = y;
 			bestVal = v;
 		}
-		board.placePiece(x, y, Piece::EMPTY);
+		setPiece(x, y, Piece::EMPTY);
 		alpha = std::max(alpha, v);
 		if (beta <= alpha)
 			break;
 	}
 
+	//a stopped search's scores mean nothing
+	if (table && !stopped()) {
+		TranspositionTable::Entry entry;
+		entry.score = bestVal;
+		entry.depth = depth;
+		entry.bound = bestVal <= alphaIn ? TranspositionTable::Bound::UPPER
+			: bestVal >= beta ? TranspositionTable::Bound::LOWER : TranspositionTable::Bound::EXACT;
+		entry.cell = bestX < 0 ? -1 : bestX * BOARDSIZE + bestY;
+		table->store(key, entry);
+	}
+
 	return std::make_tuple( bestVal,bestX,bestY );	
 }
 
 int Gomoku::checkWinner()
-{	
-	for (int x = 0; x <= BOARDSIZE; x++) {
-		for (int y = 0; y <= BOARDSIZE; y++) {
-			auto winner = singlePieceWinner(x,y);
-			if (winner) {
-				return winner;
-			}
-		}
-	}
-	return 0;
-}
-
-int Gomoku::singlePieceWinner(int x,int y) {
-	auto p = board.getPiece(x, y);
-	if (p == Piece::EMPTY) {
-		return 0;
-	}
-	int dirx[] = { 0, 1, 1, 1, 0, -1, -1, -1 };
-	int diry[] = { -1, -1, 0, 1, 1, 1, 0, -1 };
-	//how do I zip dirx diry
-	for (int d = 0; d < 8;d++) {
-		int count = 0;
-		int nx = x;
-		int ny = y;
-		for (int i = 0; i <= 4; i++) {
-			nx = nx + dirx[d];
-			ny = ny + diry[d];
-			if (nx >= 0 && nx < 15 && ny >= 0 && ny < 15) {
-				if (board.getPiece(nx, ny) != p) {
-					break;
-				}
-				else {
-					count++;
-				}
-			}
-			else
-				break;
-		}
-		if (count == 4)
-			return (int)p;
-	}
+{
+	if (threats.hasFive(Piece::BLACK))
+		return (int)Piece::BLACK;
+	if (threats.hasFive(Piece::WHITE))
+		return (int)Piece::WHITE;
 	return 0;
 }
 
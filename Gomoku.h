@@ -3,11 +3,34 @@
 #include "Board.h"
 #include <vector>
 #include <tuple>
+#include "SearchControl.h"
+#include "BatchScorer.h"
+#include "ThreatIndex.h"
+#include "EngineOptions.h"
+#include "TranspositionTable.h"
+
+//deepest ply the search may reach, sizes the per-ply move lists
+const int MAX_PLY = 16;
+//wider than any evaluation, the window a search starts with
+const int SCORE_BOUND = 99999999;
+
+//extra plies quiescence may add below the horizon
+const int QUIESCENCE_PLIES = 4;
 
 // not implementing score/weight lookup...
 // will add the other script that does it
 class Gomoku {
 	typedef std::tuple<int, int, int> ScoreXY;
+
+	//fixed size move list, one per ply so the search never touches the heap
+	struct MoveList {
+		ScoreXY moves[BOARDSIZE * BOARDSIZE];
+		//neither makes nor blocks a three or four
+		bool quiet[BOARDSIZE * BOARDSIZE];
+		int count = 0;
+		//partial selection sort, only order as far as the search gets
+		const ScoreXY& selectBest(int idx);
+	};
 public:
 	Gomoku();
 	Gomoku(const std::vector<int> &patternLookup1, const std::vector<int> &patternLookup2);
@@ -17,6 +40,7 @@ public:
 	{
 		//c++11 is good
 		this->board = Board(board);
+		threats.rebuild(this->board, patternLookup2);
 
 		//pass in the turn value.
 		int pieceCount = 0;
@@ -44,7 +68,36 @@ public:
 
 	bool placePiece(int x,int y);
 	std::pair<int,int> placePiece();
+	//takes back the stone at x,y, the turn goes back with it
+	bool removePiece(int x, int y);
+	Piece getPiece(int x, int y);
+	void setTurn(Piece p);
 	int checkWinner();
+	Piece getTurn() const;
+	//top n candidate moves for the side to move, best first
+	std::vector<std::pair<int, int>> bestMoves(int n);
+	//depth, width, margin and features apply to the next search. timeMs applies when there is
+	//no SearchControl, callers with one put the budget on its deadline
+	void setOptions(const EngineOptions& engineOptions);
+	const EngineOptions& getOptions() const;
+	//checked at every node, a cancelled search makes placePiece() return -1,-1
+	//with a deadline the search deepens iteratively and plays the deepest finished result
+	void setSearchControl(const SearchControl* searchControl);
+	//empty board, black to move
+	void reset();
+	//nodes visited by the last placePiece() search
+	long long getNodeCount() const;
+	//score of the last placePiece() search, relative to the side that moved
+	int getLastScore() const;
+	//score of the position for the side to move, searched depth plies within alpha,beta.
+	//ply is how far below some other root this position is, for searches split across processes
+	int searchScore(int depth, int ply, int alpha, int beta);
+	//shared by any number of engines and threads, nullptr (the default) for none
+	void setTranspositionTable(TranspositionTable* transpositionTable);
+	//how often the last search reduced or pruned a move, or took a score from the table
+	long long getLateReductions() const;
+	long long getFutilityPrunes() const;
+	long long getTableCutoffs() const;
 	friend std::ostream& operator<< (std::ostream& stream, const Gomoku& gomoku);
 
 private:
@@ -52,13 +105,40 @@ private:
 	// int wonScore;
 	Piece turn = Piece::BLACK;
 	Board board;
+	long long nodeCount = 0;
+	int lastScore = 0;
+	const SearchControl* control = nullptr;
+	EngineOptions options;
+	long long lateReductions = 0;
+	long long futilityPrunes = 0;
+	long long tableCutoffs = 0;
+	TranspositionTable* table = nullptr;
+	//options that change what a search returns, mixed into table keys
+	//so engines set up differently can share a table
+	uint64_t optionsKey = 0;
+	//moves searched at full depth before lmr kicks in
+	static const int LMR_FULL_MOVES = 3;
+	//two plies so the reduced search still ends on the same side's move,
+	//the leaf scores lean towards whoever moves last
+	static const int LMR_REDUCTION = 2;
+	static const int FUTILITY_MARGIN = 5000;
 	const std::vector<int> patternLookup1;
 	const std::vector<int> patternLookup2;
+	MoveList moveStack[MAX_PLY + QUIESCENCE_PLIES + 1];
+	BatchScorer batch;
+	ThreatIndex threats;
+	//every stone change goes through here so threats stays in sync with board
+	void setPiece(int x, int y, Piece p);
 	int evalBoard(Piece player, bool isOddStep);
+	int staticEval(Piece next);
 	int rowEval(int sx, int sy, int dx, int dy, Piece pType, bool isOddStep);
 	int subRowEval(int subRow, bool isOddStep);
 	Piece otherPlayer(Piece p);
-	std::vector<ScoreXY> genBestMoves(Piece cur);
-	ScoreXY negaMax(int depth, int alpha, int beta, Piece start, Piece next);
-	int singlePieceWinner(int x, int y);
+	void candidateBox(int& minX, int& maxX, int& minY, int& maxY);
+	void genBestMoves(Piece cur, MoveList& moves);
+	Threat genThreatMoves(Piece cur, MoveList& moves, bool withThrees);
+	ScoreXY quiesce(int qdepth, int ply, int alpha, int beta, Piece start, Piece next);
+	ScoreXY negaMax(int depth, int ply, int alpha, int beta, Piece start, Piece next);
+	bool stopped() const;
+	uint64_t tableKey(Piece next) const;
 };
@@ -0,0 +1,268 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdlib>
+#include "Gomoku.h"
+#include "RowEvaluator.h"
+#include "GameRecord.h"
+#include "ShardSearch.h"
+
+//re-searches every position of game record files
+//records are streamed one at a time into a bounded queue so memory stays flat
+//no matter how large the input is
+//
+//usage:
+// gomoku-analyze <pattern file> [--config file] [--queue N] [--out file]
+//                [--shards addr,addr...] [--shard-ply 1|2] [--hash MB] [--<option> value]... records...
+//options are the EngineOptions keys (--depth 6, --threads 4, --lmr 1, ...),
+//flags after --config override what it set.
+//--hash gives all threads one transposition table of that size
+//with --shards every position is searched across gomoku-worker processes, see ShardSearch.h
+// gomoku-analyze --dump records...
+//
+//output, one line per position:
+// record_id ply played_x played_y engine_x engine_y score nodes micros reductions prunes cutoffs
+//the last three are late move reductions, futility prunes and table cutoffs,
+//0 for a sharded search since workers only report nodes
+
+struct Position {
+	std::shared_ptr<const GameRecord> game;
+	//number of moves already on the board
+	int ply;
+};
+
+class PositionQueue {
+public:
+	explicit PositionQueue(size_t capacity) : capacity(capacity) {}
+
+	void push(Position p)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		notFull.wait(lock, [this]() { return queue.size() < capacity; });
+		queue.push_back(std::move(p));
+		notEmpty.notify_one();
+	}
+
+	bool pop(Position& p)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		notEmpty.wait(lock, [this]() { return !queue.empty() || closed; });
+		if (queue.empty())
+			return false;
+		p = std::move(queue.front());
+		queue.pop_front();
+		notFull.notify_one();
+		return true;
+	}
+
+	void close()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		closed = true;
+		notEmpty.notify_all();
+	}
+
+private:
+	size_t capacity;
+	bool closed = false;
+	std::deque<Position> queue;
+	std::mutex mutex;
+	std::condition_variable notEmpty;
+	std::condition_variable notFull;
+};
+
+//false if a move lands on a stone already placed, replaying it would desync the side to move
+static bool replayable(const GameRecord& game)
+{
+	bool taken[BOARDSIZE * BOARDSIZE] = { false };
+	for (const auto& m : game.moves) {
+		int cell = m.x * BOARDSIZE + m.y;
+		if (taken[cell])
+			return false;
+		taken[cell] = true;
+	}
+	return true;
+}
+
+static int dump(int argc, char** argv)
+{
+	for (int i = 2; i < argc; i++) {
+		GameRecordReader reader(argv[i]);
+		if (!reader.good()) {
+			std::cerr << argv[i] << " is not a game record file" << std::endl;
+			return 1;
+		}
+		GameRecord record;
+		while (reader.next(record)) {
+			std::cout << "game=" << record.id
+				<< " black=" << record.black
+				<< " white=" << record.white
+				<< " winner=" << record.winner
+				<< " opening=" << record.openingMoves
+				<< " moves=";
+			for (size_t m = 0; m < record.moves.size(); m++) {
+				const auto& mv = record.moves[m];
+				if (m)
+					std::cout << ";";
+				std::cout << mv.x << "," << mv.y << "," << mv.score << "," << mv.micros << "," << mv.nodes;
+			}
+			std::cout << std::endl;
+		}
+	}
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	if (argc >= 2 && std::string(argv[1]) == "--dump") {
+		return dump(argc, argv);
+	}
+	if (argc < 3) {
+		std::cerr << "usage: gomoku-analyze <pattern file> [--config file] [--queue N] [--out file] [--<option> value]... records..." << std::endl;
+		return 1;
+	}
+
+	EngineOptions options;
+	size_t queueSize = 1024;
+	std::string outFile;
+	std::vector<std::string> shards;
+	int shardPly = 1;
+	int hashMb = 0;
+	std::vector<std::string> inputs;
+	for (int i = 2; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg.compare(0, 2, "--") != 0) {
+			inputs.push_back(arg);
+			continue;
+		}
+		if (i + 1 >= argc) {
+			std::cerr << "missing value for " << arg << std::endl;
+			return 1;
+		}
+		std::string val = argv[++i];
+		if (arg == "--config") {
+			if (!options.load(val))
+				return 1;
+		}
+		else if (arg == "--queue") queueSize = std::max(1, std::atoi(val.c_str()));
+		else if (arg == "--out") outFile = val;
+		else if (arg == "--shards") shards = ShardCoordinator::parseAddresses(val);
+		else if (arg == "--shard-ply") shardPly = std::atoi(val.c_str());
+		else if (arg == "--hash") hashMb = std::max(0, std::atoi(val.c_str()));
+		else if (!options.set(arg.substr(2), val)) {
+			std::cerr << "unknown option or bad value " << arg << " " << val << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<int> patternEvals1;
+	std::vector<int> patternEvals2;
+	RowEvaluator rowEvaluator;
+	rowEvaluator.setPatterns(argv[1], patternEvals1, patternEvals2);
+
+	std::ofstream outFileStream;
+	if (!outFile.empty()) {
+		outFileStream.open(outFile);
+		if (!outFileStream) {
+			std::cerr << "cannot open " << outFile << std::endl;
+			return 1;
+		}
+	}
+	std::ostream& out = outFile.empty() ? std::cout : outFileStream;
+	std::mutex outLock;
+	long long totalNodes = 0;
+	long long totalMicros = 0;
+
+	std::unique_ptr<TranspositionTable> table;
+	if (hashMb > 0)
+		table.reset(new TranspositionTable(hashMb));
+	ShardCoordinator coordinator(shards, shardPly);
+	PositionQueue queue(queueSize);
+	auto worker = [&]() {
+		Gomoku g(patternEvals1, patternEvals2);
+		g.setOptions(options);
+		g.setTranspositionTable(table.get());
+		Position p;
+		while (queue.pop(p)) {
+			g.reset();
+			const auto& moves = p.game->moves;
+			for (int i = 0; i < p.ply; i++) {
+				g.placePiece(moves[i].x, moves[i].y);
+			}
+			auto start = std::chrono::steady_clock::now();
+			std::pair<int, int> xy;
+			int score;
+			long long nodes;
+			long long reductions = 0;
+			long long prunes = 0;
+			long long cutoffs = 0;
+			ShardResult sharded;
+			sharded.failed = true;
+			if (!shards.empty())
+				sharded = coordinator.search(g, nullptr);
+			if (sharded.failed) {
+				xy = g.placePiece();
+				score = g.getLastScore();
+				nodes = g.getNodeCount();
+				reductions = g.getLateReductions();
+				prunes = g.getFutilityPrunes();
+				cutoffs = g.getTableCutoffs();
+			}
+			else {
+				xy = { sharded.x, sharded.y };
+				score = sharded.score;
+				nodes = sharded.nodes;
+			}
+			auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now() - start).count();
+
+			std::lock_guard<std::mutex> lock(outLock);
+			totalNodes += nodes;
+			totalMicros += micros;
+			out << p.game->id << " " << p.ply << " "
+				<< moves[p.ply].x << " " << moves[p.ply].y << " "
+				<< xy.first << " " << xy.second << " "
+				<< score << " " << nodes << " " << micros << " "
+				<< reductions << " " << prunes << " " << cutoffs << "\n";
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (int t = 0; t < options.threadCount(); t++)
+		pool.emplace_back(worker);
+
+	long long games = 0;
+	for (const auto& input : inputs) {
+		GameRecordReader reader(input);
+		if (!reader.good()) {
+			std::cerr << input << " is not a game record file, skipping" << std::endl;
+			continue;
+		}
+		GameRecord record;
+		while (reader.next(record)) {
+			auto game = std::make_shared<const GameRecord>(std::move(record));
+			record = GameRecord();
+			if (!replayable(*game)) {
+				std::cerr << "game " << game->id << " in " << input << " repeats a cell, skipping" << std::endl;
+				continue;
+			}
+			for (int ply = game->openingMoves; ply < (int)game->moves.size(); ply++) {
+				queue.push({ game, ply });
+			}
+			games++;
+		}
+	}
+	queue.close();
+	for (auto& t : pool)
+		t.join();
+	out.flush();
+
+	std::cerr << "analyzed " << games << " games, "
+		<< totalNodes << " nodes, " << totalMicros / 1000 << " ms searching" << std::endl;
+}
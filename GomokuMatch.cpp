@@ -0,0 +1,247 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <memory>
+#include "Gomoku.h"
+#include "RowEvaluator.h"
+#include "GameRecord.h"
+
+//headless engine vs engine runner
+//plays N games across threads, alternating colors, from random openings
+//games are appended to a binary record file, see GameRecord.h
+//
+//usage:
+// gomoku-match [--games N] [--threads N] [--openings N] [--seed N] [--out file] [--hash MB]
+//              [--a-patterns file] [--a-config file] [--a-<option> value]...
+//              [--b-patterns file] [--b-config file] [--b-<option> value]...
+//options are the EngineOptions keys (--a-depth 6, --b-lmr 1, ...),
+//flags after --a-config override what it set.
+//--hash gives each engine a transposition table of that size, shared by its games
+
+struct EngineConfig {
+	std::string name;
+	std::string patternFile = "pattern.txt";
+	EngineOptions options;
+	std::vector<int> patternEvals1;
+	std::vector<int> patternEvals2;
+	//one per engine, the two may use different patterns
+	std::unique_ptr<TranspositionTable> table;
+};
+
+//what the pruning did, the records only keep nodes
+struct SearchStats {
+	long long reductions = 0;
+	long long prunes = 0;
+	long long cutoffs = 0;
+};
+
+struct GameResult {
+	//index of the engine playing black, 0 = A, 1 = B
+	int blackEngine;
+	//index of the winning engine, -1 for a draw
+	int winnerEngine = -1;
+	GameRecord record;
+	//by engine
+	SearchStats stats[2];
+};
+
+//openings are drawn from the square this far around the center
+static const int OPENING_RADIUS = 2;
+static const int MAX_OPENING_MOVES = (2 * OPENING_RADIUS + 1) * (2 * OPENING_RADIUS + 1);
+
+static GameResult playGame(int id, int openingMoves, unsigned seed, EngineConfig* engines[2])
+{
+	GameResult result;
+	result.blackEngine = id % 2;
+	GameRecord& record = result.record;
+	record.id = id;
+	record.black = engines[result.blackEngine]->name;
+	record.white = engines[1 - result.blackEngine]->name;
+
+	Gomoku games[2] = {
+		Gomoku(engines[0]->patternEvals1, engines[0]->patternEvals2),
+		Gomoku(engines[1]->patternEvals1, engines[1]->patternEvals2)
+	};
+	for (int e = 0; e < 2; e++) {
+		games[e].setOptions(engines[e]->options);
+		games[e].setTranspositionTable(engines[e]->table.get());
+	}
+
+	//random stones around the center, both engines see the same opening
+	std::mt19937 rng(seed + id);
+	std::uniform_int_distribution<int> near(BOARDSIZE / 2 - OPENING_RADIUS, BOARDSIZE / 2 + OPENING_RADIUS);
+	for (int i = 0; i < openingMoves; i++) {
+		int x, y;
+		do {
+			x = near(rng);
+			y = near(rng);
+		} while (!games[0].placePiece(x, y));
+		games[1].placePiece(x, y);
+		RecordedMove m;
+		m.x = x;
+		m.y = y;
+		record.moves.push_back(m);
+	}
+	record.openingMoves = openingMoves;
+
+	int toMove = (openingMoves % 2 == 0) ? result.blackEngine : 1 - result.blackEngine;
+	while (!games[0].checkWinner() && (int)record.moves.size() < BOARDSIZE * BOARDSIZE) {
+		auto start = std::chrono::steady_clock::now();
+		auto xy = games[toMove].placePiece();
+		auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - start).count();
+		games[1 - toMove].placePiece(xy.first, xy.second);
+		RecordedMove m;
+		m.x = xy.first;
+		m.y = xy.second;
+		m.score = games[toMove].getLastScore();
+		m.micros = micros;
+		m.nodes = games[toMove].getNodeCount();
+		record.moves.push_back(m);
+		result.stats[toMove].reductions += games[toMove].getLateReductions();
+		result.stats[toMove].prunes += games[toMove].getFutilityPrunes();
+		result.stats[toMove].cutoffs += games[toMove].getTableCutoffs();
+		toMove = 1 - toMove;
+	}
+
+	if (games[0].checkWinner()) {
+		//whoever made the last move won
+		result.winnerEngine = 1 - toMove;
+		record.winner = result.winnerEngine == result.blackEngine ? Piece::BLACK : Piece::WHITE;
+	}
+	return result;
+}
+
+int main(int argc, char** argv) {
+	int games = 10;
+	int threads = std::max(1u, std::thread::hardware_concurrency());
+	int openingMoves = 2;
+	unsigned seed = (unsigned)std::chrono::system_clock::now().time_since_epoch().count();
+	std::string outFile = "match_records.gmr";
+	int hashMb = 0;
+	EngineConfig a, b;
+	a.name = "A";
+	b.name = "B";
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (i + 1 >= argc) {
+			std::cerr << "missing value for " << arg << std::endl;
+			return 1;
+		}
+		std::string val = argv[++i];
+		if (arg == "--games") games = std::atoi(val.c_str());
+		else if (arg == "--threads") threads = std::max(1, std::atoi(val.c_str()));
+		else if (arg == "--openings") openingMoves = std::atoi(val.c_str());
+		else if (arg == "--seed") seed = (unsigned)std::stoul(val);
+		else if (arg == "--out") outFile = val;
+		else if (arg == "--hash") hashMb = std::max(0, std::atoi(val.c_str()));
+		else if (arg == "--a-patterns") a.patternFile = val;
+		else if (arg == "--b-patterns") b.patternFile = val;
+		else if (arg == "--a-config" || arg == "--b-config") {
+			if (!(arg[2] == 'a' ? a : b).options.load(val))
+				return 1;
+		}
+		else if ((arg.compare(0, 4, "--a-") == 0 || arg.compare(0, 4, "--b-") == 0)
+			&& (arg[2] == 'a' ? a : b).options.set(arg.substr(4), val)) {
+			//one of the engine's options
+		}
+		else {
+			std::cerr << "unknown option or bad value " << arg << " " << val << std::endl;
+			return 1;
+		}
+	}
+
+	if (openingMoves < 0 || openingMoves > MAX_OPENING_MOVES) {
+		std::cerr << "--openings must be between 0 and " << MAX_OPENING_MOVES << std::endl;
+		return 1;
+	}
+
+	EngineConfig* engines[2] = { &a, &b };
+	for (auto* e : engines) {
+		RowEvaluator rowEvaluator;
+		rowEvaluator.setPatterns(e->patternFile, e->patternEvals1, e->patternEvals2);
+		if (hashMb > 0)
+			e->table.reset(new TranspositionTable(hashMb));
+	}
+
+	GameRecordWriter out(outFile);
+	if (!out.good()) {
+		std::cerr << "cannot open " << outFile << std::endl;
+		return 1;
+	}
+
+	std::cerr << "playing " << games << " games on " << threads << " threads, seed " << seed << std::endl;
+
+	std::atomic<int> nextGame(0);
+	std::mutex resultLock;
+	int wins[2] = { 0, 0 };
+	int draws = 0;
+	long long micros[2] = { 0, 0 };
+	long long nodes[2] = { 0, 0 };
+	long long searches[2] = { 0, 0 };
+	SearchStats stats[2];
+
+	auto worker = [&]() {
+		int id;
+		while ((id = nextGame++) < games) {
+			auto result = playGame(id, openingMoves, seed, engines);
+
+			std::lock_guard<std::mutex> lock(resultLock);
+			out.write(result.record);
+			out.flush();
+			if (result.winnerEngine == -1)
+				draws++;
+			else
+				wins[result.winnerEngine]++;
+			for (int e = 0; e < 2; e++) {
+				stats[e].reductions += result.stats[e].reductions;
+				stats[e].prunes += result.stats[e].prunes;
+				stats[e].cutoffs += result.stats[e].cutoffs;
+			}
+			const auto& moves = result.record.moves;
+			for (size_t i = result.record.openingMoves; i < moves.size(); i++) {
+				int blackMoved = (i % 2 == 0);
+				int engine = blackMoved ? result.blackEngine : 1 - result.blackEngine;
+				micros[engine] += moves[i].micros;
+				nodes[engine] += moves[i].nodes;
+				searches[engine]++;
+			}
+			std::cerr << "game " << id << " done" << std::endl;
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (int t = 0; t < threads; t++)
+		pool.emplace_back(worker);
+	for (auto& t : pool)
+		t.join();
+
+	for (int e = 0; e < 2; e++) {
+		long long n = std::max(1LL, searches[e]);
+		const auto& o = engines[e]->options;
+		const auto& f = o.features;
+		std::cout << engines[e]->name << " (" << engines[e]->patternFile << ", depth " << o.depth;
+		if (o.timeMs)
+			std::cout << ", " << o.timeMs << " ms";
+		if (o.width)
+			std::cout << ", width " << o.width;
+		if (o.margin != EngineOptions().margin)
+			std::cout << ", margin " << o.margin;
+		std::cout << (f.nullWindow ? ", pvs" : "") << (f.lmr ? ", lmr" : "") << (f.futility ? ", futility" : "")
+			<< (f.quiescence ? ", qsearch" : "") << (f.quiescenceThrees ? " with threes" : "") << "): "
+			<< wins[e] << " wins, "
+			<< micros[e] / n / 1000 << " ms/move, "
+			<< nodes[e] / n << " nodes/move, "
+			<< stats[e].reductions / n << " reductions/move, "
+			<< stats[e].prunes / n << " futility prunes/move, "
+			<< stats[e].cutoffs / n << " table cutoffs/move" << std::endl;
+	}
+	std::cout << "draws: " << draws << std::endl;
+}
@@ -3,20 +3,37 @@
 #include <cpprest/uri.h>
 #include "Gomoku.h"
 #include "RowEvaluator.h"
+#include "Ponder.h"
+#include "ShardSearch.h"
 
 using namespace web;
 using namespace web::http;
 using namespace web::http::experimental::listener;
 
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <thread>
 
 using namespace std;
 
 std::vector<int> patternEvals1;
 std::vector<int> patternEvals2;
+//only set when started with --ponder
+std::unique_ptr<Ponderer> ponderer;
+SearchRegistry searches;
+//--timeout, 0 for none, requests can tighten it with timeoutMs
+int requestTimeoutMs = 0;
+//only set when started with --shards, searches are then split across gomoku-worker processes
+std::unique_ptr<ShardCoordinator> shards;
+//--config, a request's "options" object overrides them for that request
+EngineOptions engineOptions;
+//--hash, one table for every request and pondering session
+std::unique_ptr<TranspositionTable> table;
 
 void defaultOption(http_request request)
 {
@@ -29,25 +46,50 @@ void defaultOption(http_request request)
 }
 
 
+//false if a cell isn't EMPTY, BLACK or WHITE, anything else would index past the
+//board's hash keys and the pattern tables
+bool readBoard(const json::value& jsonMap, Piece(&board)[BOARDSIZE][BOARDSIZE])
+{
+	auto& boardArray = jsonMap.at(utility::conversions::to_utf8string("board")).as_array();
+	for (int i = 0; i < BOARDSIZE; i++) {
+		for (int j = 0; j < BOARDSIZE; j++) {
+			int cell = boardArray.at(i*BOARDSIZE + j).as_integer();
+			if (cell < Piece::EMPTY || cell > Piece::WHITE)
+				return false;
+			board[i][j] = (Piece)cell;
+		}
+	}
+	return true;
+}
+
+void badRequest(http_request request)
+{
+	http_response response(status_codes::BadRequest);
+	response.headers().add(U("Access-Control-Allow-Origin"), U("*"));
+	request.reply(response);
+}
+
 void isWinnerCheck(http_request request)
 {
 	cerr << "receiving post request" << endl;
 	Gomoku g(patternEvals1, patternEvals2);
 	int result = 0;
-	request.extract_json().then([&g,&result](pplx::task<json::value> task) {
+	bool valid = true;
+	request.extract_json().then([&g,&result,&valid](pplx::task<json::value> task) {
 			//I hate json and every json library
 			//protobuf when?
 			const auto& jsonMap = task.get();
-			auto& boardArray = jsonMap.at(utility::conversions::to_utf8string("board")).as_array();
 			Piece board[BOARDSIZE][BOARDSIZE];
-			for (int i = 0; i < BOARDSIZE; i++) {
-			for (int j = 0; j < BOARDSIZE; j++) {
-			board[i][j] = (Piece) boardArray.at(i*BOARDSIZE + j).as_integer();
-			}
-			}
+			valid = readBoard(jsonMap, board);
+			if (!valid)
+				return;
 			g.setBoard(board);
 			result = g.checkWinner();
 			}).wait();
+	if (!valid) {
+		badRequest(request);
+		return;
+	}
 
 	auto responseJson = json::value::object();
 	responseJson[utility::conversions::to_utf8string("winner")] = result;
@@ -57,26 +99,112 @@ void isWinnerCheck(http_request request)
 	request.reply(response);
 }
 
+//"options": {"depth": 6, "width": 20, "lmr": true, ...} with the EngineOptions keys.
+//--config is the ceiling, a request can only ask for a cheaper search
+EngineOptions requestOptions(const json::value& jsonMap)
+{
+	EngineOptions options = engineOptions;
+	auto optionsKey = utility::conversions::to_utf8string("options");
+	if (!jsonMap.has_field(optionsKey) || !jsonMap.at(optionsKey).is_object())
+		return options;
+	for (const auto& field : jsonMap.at(optionsKey).as_object()) {
+		std::string key = utility::conversions::to_utf8string(field.first);
+		std::string value;
+		if (field.second.is_boolean())
+			value = field.second.as_bool() ? "1" : "0";
+		else if (field.second.is_integer())
+			value = std::to_string(field.second.as_integer());
+		//a single request has nothing to run side by side
+		if (key == "threads" || !options.set(key, value))
+			cerr << "ignoring request option " << key << endl;
+	}
+	options.limitTo(engineOptions);
+	return options;
+}
+
+//takes a search out of the registry however the request ends
+struct FinishSearch {
+	std::shared_ptr<SearchControl> control;
+	~FinishSearch() { searches.finish(control); }
+};
+
 void getNextStep(http_request request)
 {
 	cerr << "receiving getNextStep request" << endl;
 	Gomoku g(patternEvals1, patternEvals2);
 	pair<int, int> nextXY;
-	request.extract_json().then([&g, &nextXY](pplx::task<json::value> task) {
+	bool cancelled = false;
+	bool valid = true;
+	request.extract_json().then([&g, &nextXY, &cancelled, &valid](pplx::task<json::value> task) {
 			//I hate json and every json library
 			//protobuf when?
 			const auto& jsonMap = task.get();
-			auto& boardArray = jsonMap.at(utility::conversions::to_utf8string("board")).as_array();
 			Piece board[BOARDSIZE][BOARDSIZE];
-			for (int i = 0; i < BOARDSIZE; i++) {
-			for (int j = 0; j < BOARDSIZE; j++) {
-			board[i][j] = (Piece)boardArray.at(i*BOARDSIZE + j).as_integer();
+			valid = readBoard(jsonMap, board);
+			if (!valid)
+				return;
+			std::string gameId;
+			auto gameIdKey = utility::conversions::to_utf8string("gameId");
+			if (jsonMap.has_field(gameIdKey)) {
+				gameId = jsonMap.at(gameIdKey).serialize();
+			}
+			//a newer request for the same game cancels this one,
+			//and the deadline frees the worker once the client has timed out
+			auto options = requestOptions(jsonMap);
+			//read before the control is registered, nothing may throw between start and finish
+			int timeoutMs = 0;
+			auto timeoutKey = utility::conversions::to_utf8string("timeoutMs");
+			if (jsonMap.has_field(timeoutKey)) {
+				valid = jsonMap.at(timeoutKey).is_integer();
+				if (!valid)
+					return;
+				timeoutMs = jsonMap.at(timeoutKey).as_integer();
 			}
+			auto control = searches.start(gameId);
+			FinishSearch finish{ control };
+			control->setTimeout(requestTimeoutMs);
+			control->setTimeout(options.timeMs);
+			control->setTimeout(timeoutMs);
+			//clients that send a gameId get their position pondered between moves,
+			//a hit that isn't ready within the deadline falls through to a normal search
+			if (ponderer && !gameId.empty() && ponderer->takeMove(gameId, board, nextXY, options, *control)) {
+				cerr << "ponder hit for " << gameId << endl;
+				ponderer->ponder(gameId, board, nextXY, options);
+				return;
 			}
+
+			g.setOptions(options);
+			g.setTranspositionTable(table.get());
+			g.setSearchControl(control.get());
 			g.setBoard(board);
-			nextXY = g.placePiece();
+			ShardResult sharded;
+			sharded.failed = true;
+			if (shards) {
+				sharded = shards->search(g, control.get());
+			}
+			if (sharded.failed) {
+				nextXY = g.placePiece();
+			}
+			else {
+				nextXY = { sharded.x, sharded.y };
+			}
+			cancelled = control->cancelled();
+			if (ponderer && !gameId.empty() && !cancelled) {
+				ponderer->ponder(gameId, board, nextXY, options);
+			}
 
 			}).wait();
+	if (!valid) {
+		badRequest(request);
+		return;
+	}
+	if (cancelled) {
+		cerr << "getNextStep cancelled" << endl;
+		http_response response(status_codes::ServiceUnavailable);
+		response.headers().add(U("Access-Control-Allow-Origin"), U("*"));
+		request.reply(response);
+		return;
+	}
 	auto responseJson = json::value::object();
 	responseJson[utility::conversions::to_utf8string("x")] = nextXY.first;
 	responseJson[utility::conversions::to_utf8string("y")] = nextXY.second;
@@ -91,13 +219,54 @@ void getNextStep(http_request request)
 
 int main(int argc, char** argv) {
 
-	if (argc != 2) {
+	if (argc < 2) {
 		std::cerr<< "please pass in the pattern file"<<std::endl;
+		std::cerr<< "usage: gomoku-server <pattern file> [--config file] [--hash MB] [--ponder replies] [--timeout ms] [--shards addr,addr...] [--shard-ply 1|2]"<<std::endl;
+		return 0;
 	}
 
 	RowEvaluator rowEvaluator;
 	rowEvaluator.setPatterns(argv[1],patternEvals1,patternEvals2);
 
+	std::vector<std::string> shardAddresses;
+	int shardPly = 1;
+	int ponderReplies = 0;
+	for (int i = 2; i + 1 < argc; i += 2) {
+		std::string arg = argv[i];
+		if (arg == "--config") {
+			engineOptions.load(argv[i + 1]);
+		}
+		else if (arg == "--hash") {
+			int megabytes = std::atoi(argv[i + 1]);
+			if (megabytes > 0) {
+				table.reset(new TranspositionTable(megabytes));
+			}
+		}
+		else if (arg == "--ponder") {
+			ponderReplies = std::max(1, std::atoi(argv[i + 1]));
+		}
+		else if (arg == "--timeout") {
+			requestTimeoutMs = std::atoi(argv[i + 1]);
+		}
+		else if (arg == "--shards") {
+			shardAddresses = ShardCoordinator::parseAddresses(argv[i + 1]);
+		}
+		else if (arg == "--shard-ply") {
+			shardPly = std::atoi(argv[i + 1]);
+		}
+		else {
+			std::cerr << "unknown option " << arg << std::endl;
+		}
+	}
+	if (ponderReplies > 0) {
+		//one pondering thread per game, keep at most the configured threads' worth of them
+		size_t maxSessions = engineOptions.threadCount();
+		ponderer.reset(new Ponderer(patternEvals1, patternEvals2, ponderReplies, maxSessions, table.get()));
+	}
+	if (!shardAddresses.empty()) {
+		shards.reset(new ShardCoordinator(shardAddresses, shardPly));
+	}
+
 	http_listener winnerListener(utility::conversions::to_utf8string("http://0.0.0.0:5000/api/iswinner/"));
 	winnerListener.support(methods::POST, isWinnerCheck);
 	winnerListener.support(methods::OPTIONS, defaultOption);
@@ -120,4 +289,8 @@ int main(int argc, char** argv) {
 		std::cerr << "Error: " << e.what() << "\n";
 	}
 
-}
+	searches.cancelAll();
+	if (ponderer) {
+		ponderer->stopAll();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "RowEvaluator.h"
+#include "ShardSearch.h"
+
+//worker process for searches split by gomoku-server --shards (or gomoku-analyze --shards)
+//start as many as there are cores to spare, on this host or others
+//
+//usage:
+// gomoku-worker <pattern file> <unix socket path | host:port | :port> [--hash MB]
+//:port listens on loopback only, anyone who can connect can make the worker search
+//with --hash every connection searches with one shared transposition table
+
+int main(int argc, char** argv) {
+	if (argc != 3 && !(argc == 5 && std::string(argv[3]) == "--hash")) {
+		std::cerr << "usage: gomoku-worker <pattern file> <unix socket path | host:port> [--hash MB]" << std::endl;
+		return 1;
+	}
+	std::unique_ptr<TranspositionTable> table;
+	if (argc == 5 && std::atoi(argv[4]) > 0)
+		table.reset(new TranspositionTable(std::atoi(argv[4])));
+
+	std::vector<int> patternEvals1;
+	std::vector<int> patternEvals2;
+	RowEvaluator rowEvaluator;
+	rowEvaluator.setPatterns(argv[1], patternEvals1, patternEvals2);
+
+	ShardWorker worker(patternEvals1, patternEvals2, table.get());
+	std::cerr << "serving searches on " << argv[2] << std::endl;
+	if (!worker.serve(argv[2])) {
+		std::cerr << "cannot listen on " << argv[2] << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,206 @@
+#include "Ponder.h"
+#include "Gomoku.h"
+#include <algorithm>
+#include <chrono>
+
+Ponderer::Ponderer(const std::vector<int>& patternLookup1, const std::vector<int>& patternLookup2,
+	int replies, size_t maxSessions, TranspositionTable* table) :
+	patternLookup1(patternLookup1), patternLookup2(patternLookup2),
+	replies(replies), maxSessions(maxSessions), table(table)
+{
+}
+
+Ponderer::~Ponderer()
+{
+	stopAll();
+}
+
+std::string Ponderer::keyOf(Piece(&board)[BOARDSIZE][BOARDSIZE])
+{
+	std::string key(BOARDSIZE * BOARDSIZE, '0');
+	for (int i = 0; i < BOARDSIZE; i++) {
+		for (int j = 0; j < BOARDSIZE; j++) {
+			key[i * BOARDSIZE + j] = (char)('0' + board[i][j]);
+		}
+	}
+	return key;
+}
+
+void Ponderer::cancel(const std::shared_ptr<Session>& session)
+{
+	{
+		std::lock_guard<std::mutex> guard(session->lock);
+		session->cancelled = true;
+		if (session->running)
+			session->running->cancel();
+	}
+	if (session->worker.joinable())
+		session->worker.join();
+}
+
+void Ponderer::ponder(const std::string& gameId, Piece(&board)[BOARDSIZE][BOARDSIZE], std::pair<int, int> move,
+	const EngineOptions& options)
+{
+	if (maxSessions == 0)
+		return;
+	std::vector<std::shared_ptr<Session>> evicted;
+	auto session = std::make_shared<Session>();
+	std::copy(&board[0][0], &board[0][0] + BOARDSIZE * BOARDSIZE, &session->root[0][0]);
+	session->move = move;
+	session->options = options;
+	session->optionsKey = options.toString();
+	{
+		std::lock_guard<std::mutex> guard(sessionsLock);
+		auto it = sessions.find(gameId);
+		if (it != sessions.end()) {
+			evicted.push_back(it->second);
+			sessions.erase(it);
+		}
+		//too many games pondering, drop the oldest
+		while (!sessions.empty() && sessions.size() >= maxSessions) {
+			auto oldest = sessions.begin();
+			for (auto s = sessions.begin(); s != sessions.end(); ++s) {
+				if (s->second->started < oldest->second->started)
+					oldest = s;
+			}
+			evicted.push_back(oldest->second);
+			sessions.erase(oldest);
+		}
+		session->started = sessionCounter++;
+		//started under the lock so takeMove never sees a session without a worker
+		session->worker = std::thread(&Ponderer::run, this, session.get());
+		sessions[gameId] = session;
+	}
+	for (auto& s : evicted)
+		cancel(s);
+}
+
+void Ponderer::run(Session* session)
+{
+	auto& board = session->root;
+	auto move = session->move;
+	Gomoku g(patternLookup1, patternLookup2);
+	g.setOptions(session->options);
+	g.setTranspositionTable(table);
+	g.setBoard(board);
+	Piece ours = g.getTurn();
+	Piece theirs = ours == Piece::BLACK ? Piece::WHITE : Piece::BLACK;
+	g.placePiece(move.first, move.second);
+
+	{
+		std::lock_guard<std::mutex> guard(session->lock);
+		if (!g.checkWinner()) {
+			for (auto& reply : g.bestMoves(replies)) {
+				PonderLine line;
+				std::copy(&board[0][0], &board[0][0] + BOARDSIZE * BOARDSIZE, &line.board[0][0]);
+				line.board[move.first][move.second] = ours;
+				line.board[reply.first][reply.second] = theirs;
+				line.key = keyOf(line.board);
+				session->lines.push_back(line);
+			}
+		}
+		if (session->lines.empty())
+			session->finished = true;
+		session->cv.notify_all();
+	}
+
+	for (int next = 0;; next++) {
+		//placePiece only makes its own time budget without a control, so each line gets it here
+		SearchControl control;
+		control.setTimeout(session->options.timeMs);
+		int i;
+		{
+			std::lock_guard<std::mutex> guard(session->lock);
+			i = session->wanted >= 0 ? session->wanted : next;
+			if (session->cancelled || i >= (int)session->lines.size() || session->lines[i].done)
+				break;
+			session->runningLine = i;
+			session->running = &control;
+		}
+		auto& line = session->lines[i];
+		g.setSearchControl(&control);
+		g.setBoard(line.board);
+		auto answer = g.placePiece();
+
+		std::lock_guard<std::mutex> guard(session->lock);
+		session->runningLine = -1;
+		session->running = nullptr;
+		//cancelled because another line was wanted, or the whole session was
+		if (!control.cancelled()) {
+			line.move = answer;
+			line.done = true;
+		}
+		session->cv.notify_all();
+	}
+
+	std::lock_guard<std::mutex> guard(session->lock);
+	session->finished = true;
+	session->cv.notify_all();
+}
+
+template<typename Ready>
+bool Ponderer::waitFor(Session* session, std::unique_lock<std::mutex>& guard, const SearchControl& control, Ready ready)
+{
+	//the cv can't be woken by the control, so look at it every few ms
+	const auto slice = std::chrono::milliseconds(10);
+	while (!ready()) {
+		if (control.cancelled() || control.expired())
+			return false;
+		auto until = SearchControl::Clock::now() + slice;
+		if (control.hasDeadline())
+			until = std::min(until, control.getDeadline());
+		session->cv.wait_until(guard, until);
+	}
+	return true;
+}
+
+bool Ponderer::takeMove(const std::string& gameId, Piece(&board)[BOARDSIZE][BOARDSIZE], std::pair<int, int>& move,
+	const EngineOptions& options, const SearchControl& control)
+{
+	std::shared_ptr<Session> session;
+	{
+		std::lock_guard<std::mutex> guard(sessionsLock);
+		auto it = sessions.find(gameId);
+		if (it == sessions.end())
+			return false;
+		session = it->second;
+		sessions.erase(it);
+	}
+
+	bool found = false;
+	//another tier's answers are a miss
+	if (session->optionsKey == options.toString()) {
+		std::unique_lock<std::mutex> guard(session->lock);
+		auto key = keyOf(board);
+		bool listed = waitFor(session.get(), guard, control,
+			[&]() { return !session->lines.empty() || session->finished; });
+		for (int i = 0; listed && i < (int)session->lines.size(); i++) {
+			auto& line = session->lines[i];
+			if (line.key != key)
+				continue;
+			//predicted right, stop the other lines and let this one's search finish instead of starting over
+			session->wanted = i;
+			if (session->running && session->runningLine != i)
+				session->running->cancel();
+			waitFor(session.get(), guard, control, [&]() { return line.done || session->finished; });
+			if (line.done) {
+				move = line.move;
+				found = true;
+			}
+			break;
+		}
+	}
+	cancel(session);
+	return found;
+}
+
+void Ponderer::stopAll()
+{
+	std::map<std::string, std::shared_ptr<Session>> all;
+	{
+		std::lock_guard<std::mutex> guard(sessionsLock);
+		all.swap(sessions);
+	}
+	for (auto& kvp : all)
+		cancel(kvp.second);
+}
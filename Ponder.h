@@ -0,0 +1,83 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "Board.h"
+#include "SearchControl.h"
+#include "EngineOptions.h"
+#include "TranspositionTable.h"
+
+//searches on the opponent's time
+//after the server answers a move, ponder() guesses the opponent's top replies
+//and precomputes our answer to each of them in a background thread, keyed by game.
+//takeMove() hands out a finished answer, or waits for the one being searched
+//when the actual reply matches, otherwise the stale work is cancelled.
+//the lines are searched one after another, a match skips straight to its line
+class Ponderer {
+public:
+	//table may be nullptr, pondering into the server's table also helps when the guess was wrong
+	Ponderer(const std::vector<int>& patternLookup1, const std::vector<int>& patternLookup2,
+		int replies, size_t maxSessions, TranspositionTable* table);
+	~Ponderer();
+
+	//board is the position the client sent, move is what we answered,
+	//the answers are searched with the options that request was searched with
+	void ponder(const std::string& gameId, Piece(&board)[BOARDSIZE][BOARDSIZE], std::pair<int, int> move,
+		const EngineOptions& options);
+	//true and fills move if the position was pondered with the same options and its answer
+	//was ready before control was cancelled or ran out of time
+	bool takeMove(const std::string& gameId, Piece(&board)[BOARDSIZE][BOARDSIZE], std::pair<int, int>& move,
+		const EngineOptions& options, const SearchControl& control);
+	void stopAll();
+
+private:
+	struct PonderLine {
+		std::string key;
+		Piece board[BOARDSIZE][BOARDSIZE];
+		bool done = false;
+		std::pair<int, int> move;
+	};
+
+	struct Session {
+		std::thread worker;
+		//guards everything below
+		std::mutex lock;
+		std::condition_variable cv;
+		std::vector<PonderLine> lines;
+		//the position we answered and our answer
+		Piece root[BOARDSIZE][BOARDSIZE];
+		std::pair<int, int> move;
+		EngineOptions options;
+		//options.toString(), a request asking for other options can't use these answers
+		std::string optionsKey;
+		//the line being searched and its control, nullptr between lines
+		int runningLine = -1;
+		SearchControl* running = nullptr;
+		//set by takeMove, only that line is still worth searching
+		int wanted = -1;
+		bool cancelled = false;
+		bool finished = false;
+		long long started;
+	};
+
+	static std::string keyOf(Piece(&board)[BOARDSIZE][BOARDSIZE]);
+	void run(Session* session);
+	//waits on session's cv until ready or control stops, false if it stopped first
+	template<typename Ready>
+	static bool waitFor(Session* session, std::unique_lock<std::mutex>& guard, const SearchControl& control, Ready ready);
+	static void cancel(const std::shared_ptr<Session>& session);
+
+	const std::vector<int>& patternLookup1;
+	const std::vector<int>& patternLookup2;
+	int replies;
+	size_t maxSessions;
+	TranspositionTable* table;
+	long long sessionCounter = 0;
+	std::mutex sessionsLock;
+	std::map<std::string, std::shared_ptr<Session>> sessions;
+};
@@ -0,0 +1,86 @@
+#include "SearchControl.h"
+#include <algorithm>
+
+void SearchControl::cancel()
+{
+	cancelFlag.store(true, std::memory_order_relaxed);
+}
+
+bool SearchControl::cancelled() const
+{
+	return cancelFlag.load(std::memory_order_relaxed);
+}
+
+void SearchControl::setTimeout(int ms)
+{
+	if (ms > 0)
+		setDeadline(Clock::now() + std::chrono::milliseconds(ms));
+}
+
+void SearchControl::setDeadline(Clock::time_point d)
+{
+	//keep the tighter one if set twice
+	if (!deadlineSet || d < deadline)
+		deadline = d;
+	deadlineSet = true;
+}
+
+bool SearchControl::hasDeadline() const
+{
+	return deadlineSet;
+}
+
+SearchControl::Clock::time_point SearchControl::getDeadline() const
+{
+	return deadline;
+}
+
+bool SearchControl::expired() const
+{
+	if (expiredFlag.load(std::memory_order_relaxed))
+		return true;
+	if (deadlineSet && Clock::now() >= deadline) {
+		expiredFlag.store(true, std::memory_order_relaxed);
+		return true;
+	}
+	return false;
+}
+
+bool SearchControl::shouldStop(long long nodes) const
+{
+	if (cancelled() || expiredFlag.load(std::memory_order_relaxed))
+		return true;
+	if (deadlineSet && nodes % CLOCK_INTERVAL == 0)
+		return expired();
+	return false;
+}
+
+std::shared_ptr<SearchControl> SearchRegistry::start(const std::string& key)
+{
+	auto control = std::make_shared<SearchControl>();
+	std::lock_guard<std::mutex> guard(lock);
+	if (!key.empty()) {
+		for (auto& entry : live) {
+			if (entry.first == key)
+				entry.second->cancel();
+		}
+	}
+	live.emplace_back(key, control);
+	return control;
+}
+
+void SearchRegistry::finish(const std::shared_ptr<SearchControl>& control)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	live.erase(std::remove_if(live.begin(), live.end(),
+		[&control](const std::pair<std::string, std::shared_ptr<SearchControl>>& entry) {
+			return entry.second == control;
+		}), live.end());
+}
+
+void SearchRegistry::cancelAll()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	for (auto& entry : live)
+		entry.second->cancel();
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//cancellation token and deadline for one search
+//the search polls shouldStop() at every node, the clock is only read every
+//CLOCK_INTERVAL nodes so the check stays cheap
+class SearchControl {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	void cancel();
+	bool cancelled() const;
+	//ms <= 0 means no deadline
+	void setTimeout(int ms);
+	void setDeadline(Clock::time_point deadline);
+	bool hasDeadline() const;
+	//only meaningful when hasDeadline()
+	Clock::time_point getDeadline() const;
+	bool expired() const;
+	bool shouldStop(long long nodes) const;
+
+private:
+	static const long long CLOCK_INTERVAL = 64;
+	std::atomic<bool> cancelFlag{ false };
+	mutable std::atomic<bool> expiredFlag{ false };
+	bool deadlineSet = false;
+	Clock::time_point deadline;
+};
+
+//live searches by key, so a newer request for the same game can cancel
+//the one its client gave up on, and shutdown can cancel everything
+class SearchRegistry {
+public:
+	//cancels any search already running under key, empty keys never collide
+	std::shared_ptr<SearchControl> start(const std::string& key);
+	void finish(const std::shared_ptr<SearchControl>& control);
+	void cancelAll();
+
+private:
+	std::mutex lock;
+	std::vector<std::pair<std::string, std::shared_ptr<SearchControl>>> live;
+};
@@ -0,0 +1,610 @@
+#include "ShardSearch.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+//how often a waiting coordinator looks at its SearchControl
+const int POLL_MS = 10;
+//far longer than any message, a peer that sends more without a newline is dropped
+const size_t MAX_LINE = 4096;
+
+//a path is a unix socket, host:port is tcp, an empty host is loopback.
+//the protocol has no authentication so listening anywhere else has to be asked for
+int openSocket(const std::string& address, bool listening)
+{
+	if (address.find('/') != std::string::npos) {
+		sockaddr_un addr;
+		std::memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		if (address.size() >= sizeof(addr.sun_path))
+			return -1;
+		std::strcpy(addr.sun_path, address.c_str());
+		int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0)
+			return -1;
+		if (listening) {
+			//left behind by an earlier run
+			unlink(address.c_str());
+			if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 64) < 0) {
+				close(fd);
+				return -1;
+			}
+		}
+		else if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+			close(fd);
+			return -1;
+		}
+		return fd;
+	}
+
+	auto colon = address.rfind(':');
+	if (colon == std::string::npos)
+		return -1;
+	std::string host = address.substr(0, colon);
+	std::string port = address.substr(colon + 1);
+	if (host.empty())
+		host = "127.0.0.1";
+	addrinfo hints;
+	std::memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	addrinfo* found = nullptr;
+	if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0)
+		return -1;
+	int fd = -1;
+	for (addrinfo* ai = found; ai; ai = ai->ai_next) {
+		fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+		if (fd < 0)
+			continue;
+		if (listening) {
+			int one = 1;
+			setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+			if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && listen(fd, 64) == 0)
+				break;
+		}
+		else if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+			break;
+		}
+		close(fd);
+		fd = -1;
+	}
+	freeaddrinfo(found);
+	return fd;
+}
+
+//messages are single short lines, don't let them wait for more
+void setNoDelay(int fd)
+{
+	int one = 1;
+	//fails harmlessly on unix sockets
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+bool sendAll(int fd, const std::string& data)
+{
+	size_t sent = 0;
+	while (sent < data.size()) {
+		ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		sent += n;
+	}
+	return true;
+}
+
+//splits what arrives on a socket into lines
+class LineBuffer {
+public:
+	//one read, false once the peer is gone or its line is over MAX_LINE
+	bool fill(int fd)
+	{
+		char chunk[4096];
+		ssize_t n;
+		do {
+			n = recv(fd, chunk, sizeof(chunk), 0);
+		} while (n < 0 && errno == EINTR);
+		if (n <= 0)
+			return false;
+		data.append(chunk, n);
+		auto end = data.rfind('\n');
+		size_t partial = end == std::string::npos ? data.size() : data.size() - end - 1;
+		return partial <= MAX_LINE;
+	}
+
+	bool next(std::string& line)
+	{
+		auto end = data.find('\n');
+		if (end == std::string::npos)
+			return false;
+		line = data.substr(0, end);
+		data.erase(0, end + 1);
+		return true;
+	}
+
+private:
+	std::string data;
+};
+
+struct Connection {
+	int fd = -1;
+	LineBuffer in;
+	//job in flight, -1 when idle
+	int job = -1;
+	//the job was told to stop, its answer is thrown away
+	bool stale = false;
+};
+
+struct Job {
+	int root;
+	//from the root position, the root move and maybe a reply to it
+	std::vector<std::pair<int, int>> moves;
+	int depth;
+	bool running = false;
+	bool done = false;
+};
+
+struct RootMove {
+	int x;
+	int y;
+	//its jobs are contiguous
+	int firstJob;
+	int pending;
+	//best score among its replies searched so far, from the replying side
+	int bestReply = -SCORE_BOUND;
+	bool settled = false;
+};
+
+//one fixed depth search of the root position spread over the connections
+class ShardRound {
+public:
+	ShardRound(Gomoku& g, int depth, int splitPly)
+	{
+		auto rootMoves = g.bestMoves(BOARDSIZE * BOARDSIZE);
+		for (const auto& m : rootMoves) {
+			RootMove root;
+			root.x = m.first;
+			root.y = m.second;
+			root.firstJob = (int)jobs.size();
+			std::vector<std::pair<int, int>> replies;
+			g.placePiece(m.first, m.second);
+			if (splitPly >= 2 && depth >= 2 && !g.checkWinner())
+				replies = g.bestMoves(BOARDSIZE * BOARDSIZE);
+			g.removePiece(m.first, m.second);
+
+			if (replies.empty()) {
+				addJob((int)roots.size(), { m }, depth - 1);
+			}
+			for (const auto& r : replies) {
+				addJob((int)roots.size(), { m, r }, depth - 2);
+			}
+			root.pending = (int)jobs.size() - root.firstJob;
+			roots.push_back(root);
+		}
+		unsettled = (int)roots.size();
+	}
+
+	//until every root move is settled, false if stopped or every connection dropped
+	bool run(std::vector<Connection>& connections, const SearchControl* control, long long& nodes)
+	{
+		conns = &connections;
+		nodeCount = &nodes;
+		while (unsettled > 0) {
+			if (control && (control->cancelled() || control->expired()))
+				return false;
+			std::vector<pollfd> fds;
+			std::vector<Connection*> busy;
+			for (auto& c : connections) {
+				if (c.fd >= 0 && c.job == -1)
+					dispatch(c);
+				if (c.fd >= 0 && c.job != -1) {
+					fds.push_back({ c.fd, POLLIN, 0 });
+					busy.push_back(&c);
+				}
+			}
+			if (fds.empty())
+				return false;
+			if (poll(fds.data(), fds.size(), POLL_MS) < 0 && errno != EINTR)
+				return false;
+			for (size_t i = 0; i < fds.size(); i++) {
+				if (fds[i].revents)
+					receive(*busy[i]);
+			}
+		}
+		return true;
+	}
+
+	int bestX = -1;
+	int bestY = -1;
+	int alpha = -SCORE_BOUND;
+
+private:
+	void addJob(int root, std::vector<std::pair<int, int>> moves, int depth)
+	{
+		Job job;
+		job.root = root;
+		job.moves = std::move(moves);
+		job.depth = depth;
+		jobs.push_back(std::move(job));
+	}
+
+	//the eldest brother goes first, there is no bound to share before it
+	bool eligible(int j) const
+	{
+		if (roots[0].settled)
+			return true;
+		return jobs[j].root == 0 && (j == 0 || jobs[0].done);
+	}
+
+	void dispatch(Connection& c)
+	{
+		for (int j = 0; j < (int)jobs.size(); j++) {
+			Job& job = jobs[j];
+			RootMove& root = roots[job.root];
+			if (job.running || job.done || root.settled || !eligible(j))
+				continue;
+			//the window of the position after the root move is -beta,-alpha,
+			//its own alpha is the best reply so far
+			int bound = boundFor(job.root);
+			int lo = -SCORE_BOUND;
+			int hi = -bound;
+			if (job.moves.size() == 2) {
+				lo = bound;
+				hi = -root.bestReply;
+			}
+			std::ostringstream msg;
+			msg << "J " << j << " " << job.depth << " " << lo << " " << hi << " " << job.moves.size();
+			for (const auto& m : job.moves)
+				msg << " " << m.first << " " << m.second;
+			msg << "\n";
+			if (!sendAll(c.fd, msg.str())) {
+				drop(c);
+				return;
+			}
+			job.running = true;
+			c.job = j;
+			return;
+		}
+	}
+
+	void receive(Connection& c)
+	{
+		if (!c.in.fill(c.fd)) {
+			drop(c);
+			return;
+		}
+		std::string line;
+		while (c.fd >= 0 && c.in.next(line)) {
+			std::istringstream msg(line);
+			char kind = 0;
+			int id, score, stopped;
+			long long jobNodes;
+			//an answer with no job asked for is a confused or hostile peer
+			if (!(msg >> kind >> id >> score >> jobNodes >> stopped) || kind != 'R' || c.job == -1) {
+				drop(c);
+				return;
+			}
+			*nodeCount += jobNodes;
+			int j = c.job;
+			bool stale = c.stale;
+			c.job = -1;
+			c.stale = false;
+			if (stale)
+				continue;
+			//a job stopping on its own means the worker lost track of the position
+			if (id != j || stopped) {
+				jobs[j].running = false;
+				drop(c);
+				return;
+			}
+			finish(j, score);
+		}
+	}
+
+	void finish(int j, int score)
+	{
+		Job& job = jobs[j];
+		job.running = false;
+		job.done = true;
+		RootMove& root = roots[job.root];
+		if (root.settled)
+			return;
+		int reply = job.moves.size() == 1 ? score : -score;
+		root.bestReply = std::max(root.bestReply, reply);
+		root.pending--;
+		if (root.bestReply >= -boundFor(job.root)) {
+			refute(root);
+			return;
+		}
+		if (root.pending > 0)
+			return;
+		settle(root);
+		alpha = -root.bestReply;
+		best = job.root;
+		bestX = root.x;
+		bestY = root.y;
+		//the new bound may already refute root moves still being searched
+		for (int r = 0; r < (int)roots.size(); r++) {
+			if (!roots[r].settled && roots[r].bestReply >= -boundFor(r))
+				refute(roots[r]);
+		}
+	}
+
+	//root moves ordered before the best so far win ties, like they do in a serial search,
+	//so they only need to reach alpha
+	int boundFor(int root) const
+	{
+		return root < best ? alpha - 1 : alpha;
+	}
+
+	//can't beat alpha any more, stop whatever still runs under it
+	void refute(RootMove& root)
+	{
+		settle(root);
+		int index = (int)(&root - roots.data());
+		for (auto& c : *conns) {
+			if (c.fd >= 0 && c.job != -1 && !c.stale && jobs[c.job].root == index) {
+				c.stale = true;
+				if (!sendAll(c.fd, "S\n"))
+					drop(c);
+			}
+		}
+	}
+
+	void settle(RootMove& root)
+	{
+		root.settled = true;
+		unsettled--;
+	}
+
+	void drop(Connection& c)
+	{
+		close(c.fd);
+		c.fd = -1;
+		if (c.job != -1 && !c.stale)
+			jobs[c.job].running = false;
+		c.job = -1;
+		c.stale = false;
+	}
+
+	std::vector<Job> jobs;
+	std::vector<RootMove> roots;
+	int best = -1;
+	int unsettled;
+	std::vector<Connection>* conns = nullptr;
+	long long* nodeCount = nullptr;
+};
+
+std::string positionLine(Gomoku& g)
+{
+	std::ostringstream msg;
+	msg << "P ";
+	for (int i = 0; i < BOARDSIZE; i++) {
+		for (int j = 0; j < BOARDSIZE; j++) {
+			msg << (int)g.getPiece(i, j);
+		}
+	}
+	msg << " " << (int)g.getTurn() << " " << g.getOptions().toString() << "\n";
+	return msg.str();
+}
+
+}
+
+ShardCoordinator::ShardCoordinator(const std::vector<std::string>& workers, int splitPly) :
+	workers(workers), splitPly(std::max(1, std::min(splitPly, 2)))
+{
+}
+
+std::vector<std::string> ShardCoordinator::parseAddresses(const std::string& list)
+{
+	std::vector<std::string> addresses;
+	std::istringstream in(list);
+	std::string address;
+	while (std::getline(in, address, ',')) {
+		if (!address.empty())
+			addresses.push_back(address);
+	}
+	return addresses;
+}
+
+ShardResult ShardCoordinator::search(Gomoku& g, const SearchControl* control) const
+{
+	ShardResult result;
+	//game over, nothing to split
+	if (g.checkWinner() == 0) {
+		std::string position = positionLine(g);
+		std::vector<Connection> conns;
+		for (const auto& address : workers) {
+			Connection c;
+			c.fd = openSocket(address, false);
+			if (c.fd < 0) {
+				std::cerr << "shard worker " << address << " unreachable" << std::endl;
+				continue;
+			}
+			setNoDelay(c.fd);
+			if (!sendAll(c.fd, position)) {
+				close(c.fd);
+				continue;
+			}
+			conns.push_back(std::move(c));
+		}
+		if (conns.empty()) {
+			result.failed = true;
+			return result;
+		}
+
+		//a time budget without a SearchControl gets a control of its own, like a local search
+		SearchControl budget;
+		if (!control && g.getOptions().timeMs > 0) {
+			budget.setTimeout(g.getOptions().timeMs);
+			control = &budget;
+		}
+		int depth = g.getOptions().depth;
+		bool deepen = control && control->hasDeadline();
+		for (int d = deepen ? 1 : depth; d <= depth; d++) {
+			ShardRound round(g, d, splitPly);
+			if (!round.run(conns, control, result.nodes)) {
+				result.failed = !(control && (control->cancelled() || control->expired()));
+				break;
+			}
+			result.x = round.bestX;
+			result.y = round.bestY;
+			result.score = round.alpha;
+		}
+		//workers stop whatever they still run once the connection closes
+		for (auto& c : conns) {
+			if (c.fd >= 0)
+				close(c.fd);
+		}
+		if (result.failed)
+			return result;
+	}
+	if (control && control->cancelled()) {
+		result.x = result.y = -1;
+		return result;
+	}
+	//lost already, or out of time before the first depth
+	if (result.x == -1) {
+		auto moves = g.bestMoves(1);
+		if (!moves.empty()) {
+			result.x = moves[0].first;
+			result.y = moves[0].second;
+		}
+	}
+	return result;
+}
+
+ShardWorker::ShardWorker(const std::vector<int>& patternLookup1, const std::vector<int>& patternLookup2,
+	TranspositionTable* table) :
+	patternLookup1(patternLookup1), patternLookup2(patternLookup2), table(table)
+{
+}
+
+bool ShardWorker::serve(const std::string& address)
+{
+	int listenFd = openSocket(address, true);
+	if (listenFd < 0)
+		return false;
+	while (true) {
+		int fd = accept(listenFd, nullptr, nullptr);
+		if (fd < 0) {
+			if (errno == EBADF || errno == EINVAL)
+				break;
+			continue;
+		}
+		setNoDelay(fd);
+		std::thread(&ShardWorker::session, this, fd).detach();
+	}
+	close(listenFd);
+	return false;
+}
+
+void ShardWorker::session(int fd)
+{
+	std::unique_ptr<Gomoku> g(new Gomoku(patternLookup1, patternLookup2));
+	g->setTranspositionTable(table);
+	std::unique_ptr<SearchControl> control;
+	//one job at a time, searched off this thread so a stop can still be read
+	std::thread searcher;
+	LineBuffer in;
+	std::string line;
+	while (true) {
+		bool open = true;
+		while (open && !in.next(line))
+			open = in.fill(fd);
+		if (!open)
+			break;
+		std::istringstream msg(line);
+		char kind = 0;
+		msg >> kind;
+		if (kind == 'S') {
+			if (control)
+				control->cancel();
+			continue;
+		}
+		if (searcher.joinable())
+			searcher.join();
+
+		if (kind == 'P') {
+			std::string cells;
+			int turn;
+			msg >> cells >> turn;
+			if (!msg || cells.size() != BOARDSIZE * BOARDSIZE)
+				break;
+			EngineOptions options;
+			std::string option;
+			while (msg >> option) {
+				auto eq = option.find('=');
+				if (eq != std::string::npos)
+					options.set(option.substr(0, eq), option.substr(eq + 1));
+			}
+			//a bad position closes the connection, a Piece out of range would index past the tables
+			if (cells.find_first_not_of("012") != std::string::npos || (turn != Piece::BLACK && turn != Piece::WHITE))
+				break;
+			Piece board[BOARDSIZE][BOARDSIZE];
+			for (int i = 0; i < BOARDSIZE * BOARDSIZE; i++) {
+				board[i / BOARDSIZE][i % BOARDSIZE] = (Piece)(cells[i] - '0');
+			}
+			g->setBoard(board);
+			g->setTurn((Piece)turn);
+			g->setOptions(options);
+			//a new position is a new search as far as aging goes, jobs are parts of it
+			if (table)
+				table->newSearch();
+		}
+		else if (kind == 'J') {
+			int id, depth, alpha, beta, n;
+			msg >> id >> depth >> alpha >> beta >> n;
+			std::vector<std::pair<int, int>> moves(std::max(0, std::min(n, MAX_PLY)));
+			for (auto& m : moves)
+				msg >> m.first >> m.second;
+			if (!msg)
+				break;
+			control.reset(new SearchControl());
+			g->setSearchControl(control.get());
+			searcher = std::thread([&g, &control, fd, id, depth, alpha, beta, moves]() {
+				std::vector<std::pair<int, int>> played;
+				for (const auto& m : moves) {
+					if (m.first < 0 || m.first >= BOARDSIZE || m.second < 0 || m.second >= BOARDSIZE
+						|| !g->placePiece(m.first, m.second))
+						break;
+					played.push_back(m);
+				}
+				int score = 0;
+				//an answer marked stopped makes the coordinator drop this connection
+				bool stopped = played.size() != moves.size();
+				if (!stopped) {
+					score = g->searchScore(depth, (int)played.size(), alpha, beta);
+					stopped = control->cancelled();
+				}
+				for (auto m = played.rbegin(); m != played.rend(); ++m)
+					g->removePiece(m->first, m->second);
+				std::ostringstream reply;
+				reply << "R " << id << " " << score << " " << g->getNodeCount() << " " << (stopped ? 1 : 0) << "\n";
+				sendAll(fd, reply.str());
+			});
+		}
+		else {
+			break;
+		}
+	}
+	if (control)
+		control->cancel();
+	if (searcher.joinable())
+		searcher.join();
+	close(fd);
+}
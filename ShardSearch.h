@@ -0,0 +1,61 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Gomoku.h"
+#include "SearchControl.h"
+
+//one search split across worker processes
+//the coordinator orders the moves at the root (or the root moves and every reply to them,
+//splitPly 2) and hands each subtree to an idle worker as a job with the best alpha found so far.
+//the first root move is searched before its brothers so there is a bound to share,
+//and a root move whose replies already refute it stops the jobs still running under it.
+//
+//workers are addressed by a unix socket path (anything with a '/') or host:port.
+//the wire format is one line of text per message:
+// P <225 cells 0/1/2> <turn> <key=value>...    position and EngineOptions
+// J <id> <depth> <alpha> <beta> <n> <x y>...  search after n moves
+// S                                           stop the running job
+// R <id> <score> <nodes> <stopped>            worker's answer
+
+struct ShardResult {
+	int x = -1;
+	int y = -1;
+	//relative to the side that moves, like Gomoku::getLastScore()
+	int score = 0;
+	//summed over every worker
+	long long nodes = 0;
+	//no worker could be reached or all of them dropped, search locally instead
+	bool failed = false;
+};
+
+class ShardCoordinator {
+public:
+	ShardCoordinator(const std::vector<std::string>& workers, int splitPly);
+
+	//searches g's position with g's options, g is left as it was.
+	//a cancelled search returns -1,-1, with a deadline it deepens like Gomoku::placePiece()
+	ShardResult search(Gomoku& g, const SearchControl* control) const;
+	//comma separated list of addresses
+	static std::vector<std::string> parseAddresses(const std::string& list);
+
+private:
+	std::vector<std::string> workers;
+	int splitPly;
+};
+
+//serves coordinators on a socket, every connection gets its own engine and thread
+class ShardWorker {
+public:
+	//table may be nullptr, else every connection shares it
+	ShardWorker(const std::vector<int>& patternLookup1, const std::vector<int>& patternLookup2,
+		TranspositionTable* table);
+	//blocks accepting connections, false if address can't be listened on
+	bool serve(const std::string& address);
+
+private:
+	void session(int fd);
+
+	const std::vector<int>& patternLookup1;
+	const std::vector<int>& patternLookup2;
+	TranspositionTable* table;
+};
@@ -0,0 +1,200 @@
+#include "ThreatIndex.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static int lowestBit(uint64_t v)
+{
+#ifdef _MSC_VER
+	unsigned long idx;
+	_BitScanForward64(&idx, v);
+	return (int)idx;
+#else
+	return __builtin_ctzll(v);
+#endif
+}
+
+static int bitCount(unsigned v)
+{
+#ifdef _MSC_VER
+	return (int)__popcnt(v);
+#else
+	return __builtin_popcount(v);
+#endif
+}
+
+const int ThreatIndex::dirx[DIRS] = { 1, 0, 1, 1 };
+const int ThreatIndex::diry[DIRS] = { 0, 1, 1, -1 };
+
+bool ThreatIndex::isFive(int code, int len)
+{
+	int v = code & ((1 << len) - 1);
+	return (v & (v >> 1) & (v >> 2) & (v >> 3) & (v >> 4)) != 0;
+}
+
+Threat ThreatIndex::shapeOf(int code, int len, int bit)
+{
+	int v = code & ((1 << len) - 1);
+	//only fives through the stone, a line that already holds one elsewhere doesn't count
+	int best = 0;
+	for (int b = std::max(0, bit - 4); b <= bit && b + 5 <= len; b++)
+		best = std::max(best, bitCount((v >> b) & 0x1f));
+	if (best == 5)
+		return Threat::FIVE;
+	if (best == 4)
+		return Threat::FOUR;
+	//the middle 4 of the window hold the stone, its ends stay empty
+	for (int b = std::max(0, bit - 4); b < bit && b + 6 <= len; b++) {
+		int window = (v >> b) & 0x3f;
+		if (!(window & 0x21) && bitCount(window) == 3)
+			return Threat::THREE;
+	}
+	return Threat::NONE;
+}
+
+void ThreatIndex::rebuild(Board& board, const std::vector<int>& evenStepTable)
+{
+	std::memset(codes, 0, sizeof(codes));
+	std::memset(dirGains, 0, sizeof(dirGains));
+	std::memset(dirLevels, 0, sizeof(dirLevels));
+	std::memset(gains, 0, sizeof(gains));
+	std::memset(levels, 0, sizeof(levels));
+	std::memset(counts, 0, sizeof(counts));
+	std::memset(masks, 0, sizeof(masks));
+	std::memset(lineFives, 0, sizeof(lineFives));
+	std::memset(fives, 0, sizeof(fives));
+	for (int s = 0; s < 2; s++) {
+		counts[s][(int)Threat::NONE] = CELLS;
+		for (int w = 0; w < 4; w++)
+			masks[s][(int)Threat::NONE][w] = ~0ULL;
+	}
+
+	//every line touches the first row or one of the side columns
+	for (int i = 0; i < BOARDSIZE; i++) {
+		updateLine(board, 0, 0, i, evenStepTable);
+		updateLine(board, 1, i, 0, evenStepTable);
+		updateLine(board, 2, 0, i, evenStepTable);
+		updateLine(board, 2, i, 0, evenStepTable);
+		updateLine(board, 3, 0, i, evenStepTable);
+		updateLine(board, 3, i, BOARDSIZE - 1, evenStepTable);
+	}
+}
+
+void ThreatIndex::update(Board& board, int x, int y, const std::vector<int>& evenStepTable)
+{
+	for (int d = 0; d < DIRS; d++) {
+		updateLine(board, d, x, y, evenStepTable);
+	}
+}
+
+void ThreatIndex::updateLine(Board& board, int dir, int x, int y, const std::vector<int>& evenStepTable)
+{
+	int dx = dirx[dir];
+	int dy = diry[dir];
+	//back up to the edge
+	while (x - dx >= 0 && x - dx < BOARDSIZE && y - dy >= 0 && y - dy < BOARDSIZE) {
+		x -= dx;
+		y -= dy;
+	}
+	int line = dir == 0 ? y : dir == 1 ? x : dir == 2 ? x - y + BOARDSIZE - 1 : x + y;
+
+	int cellOf[BOARDSIZE];
+	Piece pieces[BOARDSIZE];
+	int n = 0;
+	for (; x >= 0 && x < BOARDSIZE && y >= 0 && y < BOARDSIZE; x += dx, y += dy) {
+		cellOf[n] = x * BOARDSIZE + y;
+		pieces[n] = board.getPiece(x, y);
+		n++;
+	}
+
+	for (int s = 0; s < 2; s++) {
+		Piece self = s == 0 ? Piece::BLACK : Piece::WHITE;
+		Piece opponent = s == 0 ? Piece::WHITE : Piece::BLACK;
+		bool lineFive = false;
+		int start = 0;
+		while (start < n) {
+			if (pieces[start] == opponent) {
+				int cell = cellOf[start];
+				codes[s][dir][cell][0] = codes[s][dir][cell][1] = 0;
+				dirGains[s][dir][cell] = 0;
+				dirLevels[s][dir][cell] = (uint8_t)Threat::NONE;
+				start++;
+				continue;
+			}
+			//segment [start, end) bounded by the opponent or the edge
+			int end = start;
+			int code = 1;
+			while (end < n && pieces[end] != opponent) {
+				code = (code << 1) ^ (pieces[end] == self ? 1 : 0);
+				end++;
+			}
+			int len = end - start;
+			lineFive = lineFive || isFive(code, len);
+			for (int k = start; k < end; k++) {
+				int cell = cellOf[k];
+				if (pieces[k] != Piece::EMPTY) {
+					codes[s][dir][cell][0] = codes[s][dir][cell][1] = 0;
+					dirGains[s][dir][cell] = 0;
+					dirLevels[s][dir][cell] = (uint8_t)Threat::NONE;
+					continue;
+				}
+				int with = code | (1 << (end - 1 - k));
+				codes[s][dir][cell][0] = code;
+				codes[s][dir][cell][1] = with;
+				//an engine built without pattern tables still gets the levels and fives
+				dirGains[s][dir][cell] = evenStepTable.empty() ? 0 : evenStepTable[with] - evenStepTable[code];
+				dirLevels[s][dir][cell] = (uint8_t)shapeOf(with, len, end - 1 - k);
+			}
+			start = end;
+		}
+
+		if (lineFives[s][dir][line] != lineFive) {
+			lineFives[s][dir][line] = lineFive;
+			fives[s] += lineFive ? 1 : -1;
+		}
+		for (int k = 0; k < n; k++) {
+			refreshCell(s, cellOf[k]);
+		}
+	}
+}
+
+void ThreatIndex::refreshCell(int s, int cell)
+{
+	int best = 0;
+	int strongest = (int)Threat::NONE;
+	for (int d = 0; d < DIRS; d++) {
+		best = std::max(best, dirGains[s][d][cell]);
+		strongest = std::max(strongest, (int)dirLevels[s][d][cell]);
+	}
+	gains[s][cell] = best;
+	auto level = (Threat)strongest;
+
+	int old = levels[s][cell];
+	if (old == (int)level)
+		return;
+	counts[s][old]--;
+	masks[s][old][cell / 64] &= ~(1ULL << (cell % 64));
+	levels[s][cell] = (uint8_t)level;
+	counts[s][(int)level]++;
+	masks[s][(int)level][cell / 64] |= 1ULL << (cell % 64);
+}
+
+int ThreatIndex::cells(Piece p, Threat level, int* out) const
+{
+	int n = 0;
+	const uint64_t* words = masks[side(p)][(int)level];
+	for (int w = 0; w < 4; w++) {
+		uint64_t bits = words[w];
+		while (bits) {
+			int cell = w * 64 + lowestBit(bits);
+			if (cell >= CELLS)
+				return n;
+			out[n++] = cell;
+			bits &= bits - 1;
+		}
+	}
+	return n;
+}
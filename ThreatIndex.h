@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Board.h"
+
+enum class Threat {
+	NONE,
+	THREE,
+	FOUR,
+	FIVE,
+	//only as a move generator result, the opponent has a five to block
+	FIVE_BLOCK
+};
+
+//for every empty cell, direction and side: the code of the segment through the cell
+//(as rowEval builds it) without and with a stone there, and what that stone makes.
+//update() redoes only the 4 lines through a changed cell, so "where can p make five"
+//or "does p have five on the board" are lookups instead of board scans.
+//the levels come from the stones alone, not the pattern tables, so they mean the same
+//whatever pattern file the engine loaded:
+// FIVE  five in a row through the cell
+// FOUR  a window of 5 through the cell with 4 stones, one more makes five
+// THREE a window of 6 with empty ends and 3 stones in the middle 4 through the cell,
+//       one more makes an open four
+class ThreatIndex {
+public:
+	static const int CELLS = BOARDSIZE * BOARDSIZE;
+	static const int DIRS = 4;
+	static const int dirx[DIRS];
+	static const int diry[DIRS];
+
+	//an empty evenStepTable leaves every gain 0, levels and fives don't need it
+	void rebuild(Board& board, const std::vector<int>& evenStepTable);
+	//call after the stone at x,y changed
+	void update(Board& board, int x, int y, const std::vector<int>& evenStepTable);
+
+	int before(Piece p, int dir, int cell) const { return codes[side(p)][dir][cell][0]; }
+	int after(Piece p, int dir, int cell) const { return codes[side(p)][dir][cell][1]; }
+	//best single line gain of a stone for p at cell
+	int gain(Piece p, int cell) const { return gains[side(p)][cell]; }
+	Threat level(Piece p, int cell) const { return (Threat)levels[side(p)][cell]; }
+	int count(Piece p, Threat level) const { return counts[side(p)][(int)level]; }
+	//fills out with the cells where p reaches exactly level, in board order.
+	//out must have room for CELLS of them
+	int cells(Piece p, Threat level, int* out) const;
+	//p has five in a row on the board
+	bool hasFive(Piece p) const { return fives[side(p)] > 0; }
+
+private:
+	static int side(Piece p) { return p == Piece::BLACK ? 0 : 1; }
+	static bool isFive(int code, int len);
+	//what a stone at bit of code (already in it) makes along the segment
+	static Threat shapeOf(int code, int len, int bit);
+	void updateLine(Board& board, int dir, int x, int y, const std::vector<int>& evenStepTable);
+	void refreshCell(int s, int cell);
+
+	//[side][dir][cell][without, with]
+	int codes[2][DIRS][CELLS][2];
+	int dirGains[2][DIRS][CELLS];
+	uint8_t dirLevels[2][DIRS][CELLS];
+	int gains[2][CELLS];
+	uint8_t levels[2][CELLS];
+	int counts[2][4];
+	//cells by level, 4 words of 64 cover the board
+	uint64_t masks[2][4][4];
+	//lines holding five in a row, by direction and line number
+	bool lineFives[2][DIRS][2 * BOARDSIZE - 1];
+	int fives[2];
+};
@@ -0,0 +1,172 @@
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "Gomoku.h"
+#include "RowEvaluator.h"
+#include "ThreatIndex.h"
+
+//fuzzes the incremental threat index against brute force board scans.
+//random stones are placed and removed, after every change the index must agree with
+//a scan for fives on the board and for the cells where a stone makes five,
+//and with an index rebuilt from scratch. run by ctest
+//
+//usage:
+// gomoku-check [pattern file] [--games N] [--seed N]
+
+static const int dirx[4] = { 1, 0, 1, 1 };
+static const int diry[4] = { 0, 1, 1, -1 };
+
+static bool onBoard(int x, int y)
+{
+	return x >= 0 && x < BOARDSIZE && y >= 0 && y < BOARDSIZE;
+}
+
+//five or more in a row through x,y for the stone there
+static bool fiveThrough(Board& board, int x, int y)
+{
+	Piece p = board.getPiece(x, y);
+	if (p == Piece::EMPTY)
+		return false;
+	for (int d = 0; d < 4; d++) {
+		int run = 1;
+		for (int s = -1; s <= 1; s += 2) {
+			int cx = x + s * dirx[d];
+			int cy = y + s * diry[d];
+			while (onBoard(cx, cy) && board.getPiece(cx, cy) == p) {
+				run++;
+				cx += s * dirx[d];
+				cy += s * diry[d];
+			}
+		}
+		if (run >= 5)
+			return true;
+	}
+	return false;
+}
+
+static bool hasFive(Board& board, Piece p)
+{
+	for (int x = 0; x < BOARDSIZE; x++) {
+		for (int y = 0; y < BOARDSIZE; y++) {
+			if (board.getPiece(x, y) == p && fiveThrough(board, x, y))
+				return true;
+		}
+	}
+	return false;
+}
+
+static bool makesFive(Board& board, Piece p, int x, int y)
+{
+	if (board.getPiece(x, y) != Piece::EMPTY)
+		return false;
+	board.placePiece(x, y, p);
+	bool five = fiveThrough(board, x, y);
+	board.placePiece(x, y, Piece::EMPTY);
+	return five;
+}
+
+//empty string if index agrees with board
+static std::string compare(Board& board, const ThreatIndex& index, const std::vector<int>& evenStepTable)
+{
+	ThreatIndex fresh;
+	fresh.rebuild(board, evenStepTable);
+	int cells[ThreatIndex::CELLS];
+	for (Piece p : { Piece::BLACK, Piece::WHITE }) {
+		if (index.hasFive(p) != hasFive(board, p))
+			return "hasFive";
+		int n = index.cells(p, Threat::FIVE, cells);
+		int expected = 0;
+		for (int cell = 0; cell < ThreatIndex::CELLS; cell++) {
+			bool five = makesFive(board, p, cell / BOARDSIZE, cell % BOARDSIZE);
+			if (five != (index.level(p, cell) == Threat::FIVE))
+				return "five level at " + std::to_string(cell);
+			if (index.level(p, cell) != fresh.level(p, cell) || index.gain(p, cell) != fresh.gain(p, cell))
+				return "rebuild differs at " + std::to_string(cell);
+			expected += five ? 1 : 0;
+		}
+		if (n != expected || n != index.count(p, Threat::FIVE))
+			return "five cells";
+	}
+	return "";
+}
+
+int main(int argc, char** argv) {
+	std::string patternFile;
+	int games = 200;
+	unsigned seed = 1;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--games" && i + 1 < argc) games = std::atoi(argv[++i]);
+		else if (arg == "--seed" && i + 1 < argc) seed = (unsigned)std::stoul(argv[++i]);
+		else patternFile = arg;
+	}
+
+	std::vector<int> patternEvals1;
+	std::vector<int> patternEvals2;
+	if (!patternFile.empty()) {
+		RowEvaluator rowEvaluator;
+		rowEvaluator.setPatterns(patternFile, patternEvals1, patternEvals2);
+	}
+
+	std::mt19937 rng(seed);
+	//stones bunched in the middle make lines, the odd removal exercises the way back
+	std::uniform_int_distribution<int> near(BOARDSIZE / 2 - 4, BOARDSIZE / 2 + 4);
+	std::uniform_int_distribution<int> anywhere(0, BOARDSIZE - 1);
+	std::uniform_int_distribution<int> percent(0, 99);
+	long long checks = 0;
+	for (int game = 0; game < games; game++) {
+		Board board;
+		ThreatIndex index;
+		index.rebuild(board, patternEvals2);
+		std::vector<std::pair<int, int>> placed;
+		Piece turn = Piece::BLACK;
+		for (int step = 0; step < 80; step++) {
+			int x, y;
+			if (!placed.empty() && percent(rng) < 15) {
+				auto at = placed.begin() + rng() % placed.size();
+				x = at->first;
+				y = at->second;
+				placed.erase(at);
+				board.placePiece(x, y, Piece::EMPTY);
+			}
+			else {
+				bool wide = percent(rng) < 20;
+				x = wide ? anywhere(rng) : near(rng);
+				y = wide ? anywhere(rng) : near(rng);
+				if (board.getPiece(x, y) != Piece::EMPTY)
+					continue;
+				board.placePiece(x, y, turn);
+				placed.emplace_back(x, y);
+				turn = turn == Piece::BLACK ? Piece::WHITE : Piece::BLACK;
+			}
+			index.update(board, x, y, patternEvals2);
+			auto error = compare(board, index, patternEvals2);
+			checks++;
+			if (!error.empty()) {
+				std::cerr << "game " << game << " step " << step << " seed " << seed << ": " << error << std::endl;
+				std::cerr << board << std::endl;
+				return 1;
+			}
+		}
+
+		//the engine's own winner check rides on the index
+		Gomoku g(patternEvals1, patternEvals2);
+		Piece copy[BOARDSIZE][BOARDSIZE];
+		for (int x = 0; x < BOARDSIZE; x++) {
+			for (int y = 0; y < BOARDSIZE; y++)
+				copy[x][y] = board.getPiece(x, y);
+		}
+		g.setBoard(copy);
+		int expected = hasFive(board, Piece::BLACK) ? (int)Piece::BLACK
+			: hasFive(board, Piece::WHITE) ? (int)Piece::WHITE : 0;
+		if (g.checkWinner() != expected) {
+			std::cerr << "game " << game << " seed " << seed << ": checkWinner " << g.checkWinner()
+				<< " expected " << expected << std::endl;
+			return 1;
+		}
+	}
+	std::cout << checks << " positions checked" << std::endl;
+	return 0;
+}
@@ -0,0 +1,118 @@
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <new>
+
+//data layout, low to high: score 32 bits, cell + 1 8 bits, depth 8 bits, bound 2 bits, generation 14 bits.
+//a slot never written is all zero, which can't match any key but 0
+static const int CACHE_LINE = 64;
+static const int GENERATION_BITS = 14;
+static const unsigned GENERATION_MASK = (1u << GENERATION_BITS) - 1;
+//14 bits of one second epochs wrap after about four and a half hours
+static const std::chrono::seconds EPOCH(1);
+
+TranspositionTable::TranspositionTable(size_t megabytes) :
+	created(std::chrono::steady_clock::now())
+{
+	size_t count = 1;
+	while (count * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024)
+		count *= 2;
+	bucketMask = count - 1;
+	//aligned by hand so a bucket never straddles two lines
+	memory.reset(new char[count * sizeof(Bucket) + CACHE_LINE]);
+	auto base = reinterpret_cast<uintptr_t>(memory.get());
+	auto aligned = (base + CACHE_LINE - 1) & ~(uintptr_t)(CACHE_LINE - 1);
+	buckets = reinterpret_cast<Bucket*>(aligned);
+	for (size_t i = 0; i < count; i++) {
+		new (&buckets[i]) Bucket();
+		for (auto& slot : buckets[i].slots) {
+			slot.check.store(0, std::memory_order_relaxed);
+			slot.data.store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+size_t TranspositionTable::capacity() const
+{
+	return (bucketMask + 1) * BUCKET_SLOTS;
+}
+
+void TranspositionTable::newSearch()
+{
+	auto epochs = (std::chrono::steady_clock::now() - created) / EPOCH;
+	generation.store((unsigned)epochs & GENERATION_MASK, std::memory_order_relaxed);
+}
+
+uint64_t TranspositionTable::pack(const Entry& entry, unsigned gen)
+{
+	return (uint64_t)(uint32_t)entry.score
+		| (uint64_t)(uint8_t)(entry.cell + 1) << 32
+		| (uint64_t)(uint8_t)std::min(entry.depth, 255) << 40
+		| (uint64_t)entry.bound << 48
+		| (uint64_t)(gen & GENERATION_MASK) << 50;
+}
+
+TranspositionTable::Entry TranspositionTable::unpack(uint64_t data)
+{
+	Entry entry;
+	entry.score = (int32_t)(uint32_t)data;
+	entry.cell = (int)((data >> 32) & 0xff) - 1;
+	entry.depth = (int)((data >> 40) & 0xff);
+	entry.bound = (Bound)((data >> 48) & 0x3);
+	return entry;
+}
+
+unsigned TranspositionTable::generationOf(uint64_t data)
+{
+	return (unsigned)(data >> 50) & GENERATION_MASK;
+}
+
+TranspositionTable::Bucket& TranspositionTable::bucketOf(uint64_t key) const
+{
+	return buckets[key & bucketMask];
+}
+
+bool TranspositionTable::probe(uint64_t key, Entry& entry) const
+{
+	for (auto& slot : bucketOf(key).slots) {
+		uint64_t data = slot.data.load(std::memory_order_relaxed);
+		if ((slot.check.load(std::memory_order_relaxed) ^ data) == key) {
+			entry = unpack(data);
+			return true;
+		}
+	}
+	return false;
+}
+
+void TranspositionTable::store(uint64_t key, const Entry& entry)
+{
+	unsigned gen = generation.load(std::memory_order_relaxed);
+	Bucket& bucket = bucketOf(key);
+	//the same position, else the slot worth least: shallow and from long ago
+	Slot* victim = nullptr;
+	int worst = 0;
+	for (auto& slot : bucket.slots) {
+		uint64_t data = slot.data.load(std::memory_order_relaxed);
+		if ((slot.check.load(std::memory_order_relaxed) ^ data) == key) {
+			victim = &slot;
+			//a search that ended without a move keeps the one found before
+			if (entry.cell < 0) {
+				Entry kept = entry;
+				kept.cell = unpack(data).cell;
+				uint64_t packed = pack(kept, gen);
+				slot.data.store(packed, std::memory_order_relaxed);
+				slot.check.store(key ^ packed, std::memory_order_relaxed);
+				return;
+			}
+			break;
+		}
+		int age = (int)((gen - generationOf(data)) & GENERATION_MASK);
+		int worth = unpack(data).depth - 2 * age;
+		if (!victim || worth < worst) {
+			victim = &slot;
+			worst = worth;
+		}
+	}
+	uint64_t packed = pack(entry, gen);
+	victim->data.store(packed, std::memory_order_relaxed);
+	victim->check.store(key ^ packed, std::memory_order_relaxed);
+}
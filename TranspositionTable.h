@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+//search results by position hash, shared by every engine in the process without locks.
+//each slot is two relaxed 64 bit atomics, the packed entry and the key xor'd with it.
+//a slot torn by two threads writing at once no longer matches its key and reads as a miss,
+//so the worst a race does is lose an entry.
+//only share a table between engines using the same pattern tables, Gomoku mixes its
+//options into the key but knows nothing about where its tables came from
+class TranspositionTable {
+public:
+	enum class Bound : uint8_t {
+		EXACT,
+		//the score is at least this, the search failed high
+		LOWER,
+		//at most this, it failed low
+		UPPER
+	};
+
+	struct Entry {
+		int score;
+		int depth;
+		Bound bound;
+		//best move as x * BOARDSIZE + y, -1 for none
+		int cell;
+	};
+
+	//rounds down to a power of two buckets of 4 slots, at least one bucket
+	explicit TranspositionTable(size_t megabytes);
+
+	bool probe(uint64_t key, Entry& entry) const;
+	void store(uint64_t key, const Entry& entry);
+	//call when a search starts. the generation moves on once per epoch of wall time rather
+	//than per search, so thousands of concurrent games don't wrap it within seconds.
+	//entries from older generations are replaced first
+	void newSearch();
+	size_t capacity() const;
+
+private:
+	struct Slot {
+		std::atomic<uint64_t> check;
+		std::atomic<uint64_t> data;
+	};
+	//one cache line
+	static const int BUCKET_SLOTS = 4;
+	struct Bucket {
+		Slot slots[BUCKET_SLOTS];
+	};
+
+	static uint64_t pack(const Entry& entry, unsigned generation);
+	static Entry unpack(uint64_t data);
+	static unsigned generationOf(uint64_t data);
+	Bucket& bucketOf(uint64_t key) const;
+
+	std::unique_ptr<char[]> memory;
+	Bucket* buckets;
+	size_t bucketMask;
+	std::chrono::steady_clock::time_point created;
+	std::atomic<unsigned> generation{ 0 };
+};